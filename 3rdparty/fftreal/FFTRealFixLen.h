@@ -38,6 +38,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include	"Array.h"
 #include	"DynArray.h"
 #include	"FFTRealFixLenParam.h"
+#include	"FFTRealLut.h"
 #include	"OscSinCos.h"
 
 
@@ -91,16 +92,16 @@ private:
 	enum {			NBR_TRIGO_OSC			= FFT_LEN_L2 - TRIGO_BD	};
 	enum {			TRIGO_OSC_ARR_SIZE	=	(NBR_TRIGO_OSC > 0) ? NBR_TRIGO_OSC : 1	};
 
-	void				build_br_lut ();
-	void				build_trigo_lut ();
 	void				build_trigo_osc ();
 
+	// Length-only tables, built at compile time and shared by all instances
+	static constexpr FFTRealLutArray <long, BR_ARR_SIZE>
+						_br_data = FFTRealLut::build_br <BR_ARR_SIZE, FFT_LEN_L2> ();
+	static constexpr FFTRealLutArray <DataType, TRIGO_TABLE_ARR_SIZE>
+						_trigo_data = FFTRealLut::build_trigo <DataType, TRIGO_TABLE_ARR_SIZE> ();
+
 	DynArray <DataType>
 						_buffer;
-	DynArray <long>
-						_br_data;
-	DynArray <DataType>
-						_trigo_data;
    Array <OscType, TRIGO_OSC_ARR_SIZE>
 						_trigo_osc;
 
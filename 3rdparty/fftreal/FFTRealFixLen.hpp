@@ -54,12 +54,8 @@ namespace std { }
 template <int LL2>
 FFTRealFixLen <LL2>::FFTRealFixLen ()
 :	_buffer (FFT_LEN)
-,	_br_data (BR_ARR_SIZE)
-,	_trigo_data (TRIGO_TABLE_ARR_SIZE)
 ,	_trigo_osc ()
 {
-	build_br_lut ();
-	build_trigo_lut ();
 	build_trigo_osc ();
 }
 
@@ -258,46 +254,6 @@ void	FFTRealFixLen <LL2>::rescale (DataType x []) const
 
 
 
-template <int LL2>
-void	FFTRealFixLen <LL2>::build_br_lut ()
-{
-	_br_data [0] = 0;
-	for (long cnt = 1; cnt < BR_ARR_SIZE; ++cnt)
-	{
-		long				index = cnt << 2;
-		long				br_index = 0;
-
-		int				bit_cnt = FFT_LEN_L2;
-		do
-		{
-			br_index <<= 1;
-			br_index += (index & 1);
-			index >>= 1;
-
-			-- bit_cnt;
-		}
-		while (bit_cnt > 0);
-
-		_br_data [cnt] = br_index;
-	}
-}
-
-
-
-template <int LL2>
-void	FFTRealFixLen <LL2>::build_trigo_lut ()
-{
-	const double	mul = (0.5 * PI) / TRIGO_TABLE_ARR_SIZE;
-	for (long i = 0; i < TRIGO_TABLE_ARR_SIZE; ++ i)
-	{
-		using namespace std;
-
-		_trigo_data [i] = DataType (cos (i * mul));
-	}
-}
-
-
-
 template <int LL2>
 void	FFTRealFixLen <LL2>::build_trigo_osc ()
 {
@@ -0,0 +1,196 @@
+/*****************************************************************************
+
+        FFTRealLut.h
+
+Compile-time generation of the lookup tables used by FFTRealFixLen.
+
+The tables only depend on the FFT length, which is a template parameter, so
+they are computed by the compiler and placed in read-only storage shared by
+every FFTRealFixLen instance of the same length.
+
+--- Legal stuff ---
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*Tab=3***********************************************************************/
+
+
+
+#if ! defined (FFTRealLut_HEADER_INCLUDED)
+#define	FFTRealLut_HEADER_INCLUDED
+
+#if defined (_MSC_VER)
+	#pragma once
+	#pragma warning (4 : 4250) // "Inherits via dominance."
+#endif
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include	"def.h"
+
+
+
+template <class T, long LEN>
+struct FFTRealLutArray
+{
+	T					_data [LEN];
+
+	constexpr const T &
+						operator [] (long pos) const { return (_data [pos]); }
+};
+
+
+
+class FFTRealLut
+{
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+public:
+
+	// Bit-reversed indexes of every 4th input sample
+	template <long LEN, int FFT_LEN_L2>
+	static constexpr FFTRealLutArray <long, LEN>
+						build_br ();
+
+	// cos (i * PI / (2 * LEN)) for i in [0 ; LEN - 1]
+	template <class T, long LEN>
+	static constexpr FFTRealLutArray <T, LEN>
+						build_trigo ();
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+	static constexpr double
+						cos_quarter (double x);
+	static constexpr double
+						cos_taylor (double x);
+	static constexpr double
+						sin_taylor (double x);
+
+
+
+/*\\\ FORBIDDEN MEMBER FUNCTIONS \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+						FFTRealLut ();
+
+};	// class FFTRealLut
+
+
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+template <long LEN, int FFT_LEN_L2>
+constexpr FFTRealLutArray <long, LEN>	FFTRealLut::build_br ()
+{
+	FFTRealLutArray <long, LEN>	lut {};
+	for (long cnt = 1; cnt < LEN; ++cnt)
+	{
+		long				index = cnt << 2;
+		long				br_index = 0;
+
+		int				bit_cnt = FFT_LEN_L2;
+		do
+		{
+			br_index <<= 1;
+			br_index += (index & 1);
+			index >>= 1;
+
+			-- bit_cnt;
+		}
+		while (bit_cnt > 0);
+
+		lut._data [cnt] = br_index;
+	}
+
+	return (lut);
+}
+
+
+
+template <class T, long LEN>
+constexpr FFTRealLutArray <T, LEN>	FFTRealLut::build_trigo ()
+{
+	FFTRealLutArray <T, LEN>	lut {};
+	const double	mul = (0.5 * PI) / LEN;
+	for (long i = 0; i < LEN; ++ i)
+	{
+		lut._data [i] = T (cos_quarter (i * mul));
+	}
+
+	return (lut);
+}
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+// x in [0 ; PI/2]. The series are kept under PI/4, where 12 terms are far
+// below double precision.
+constexpr double	FFTRealLut::cos_quarter (double x)
+{
+	return ((x <= 0.25 * PI) ? cos_taylor (x) : sin_taylor (0.5 * PI - x));
+}
+
+
+
+constexpr double	FFTRealLut::cos_taylor (double x)
+{
+	const double	x2 = x * x;
+	double			term = 1;
+	double			sum = 1;
+	for (int n = 2; n <= 24; n += 2)
+	{
+		term *= -x2 / (n * (n - 1));
+		sum += term;
+	}
+
+	return (sum);
+}
+
+
+
+constexpr double	FFTRealLut::sin_taylor (double x)
+{
+	const double	x2 = x * x;
+	double			term = x;
+	double			sum = x;
+	for (int n = 3; n <= 25; n += 2)
+	{
+		term *= -x2 / (n * (n - 1));
+		sum += term;
+	}
+
+	return (sum);
+}
+
+
+
+#endif	// FFTRealLut_HEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
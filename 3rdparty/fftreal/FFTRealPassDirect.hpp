@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 /*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
 
 #include	"FFTRealUseTrigo.h"
+#include	"fftreal_simd.h"
 
 
 
@@ -47,6 +48,13 @@ template <>
 void	FFTRealPassDirect <1>::process (long len, DataType dest_ptr [], DataType src_ptr [], const DataType x_ptr [], const DataType cos_ptr [], long cos_len, const long br_ptr [], OscType osc_list [])
 {
 	// First and second pass at once
+	const FFTRealSimd::Pass12Function	simd_fnc = FFTRealSimd::kernels ().pass_1_2;
+	if (simd_fnc != 0 && (len & 15) == 0)
+	{
+		simd_fnc (len, dest_ptr, x_ptr, br_ptr);
+		return;
+	}
+
 	const long		qlen = len >> 2;
 
 	long				coef_index = 0;
@@ -140,6 +148,12 @@ void	FFTRealPassDirect <PASS>::process (long len, DataType dest_ptr [], DataType
    enum {	TRIGO_OSC		= PASS - FFTRealFixLenParam::TRIGO_BD_LIMIT	};
 	enum {	TRIGO_DIRECT	= (TRIGO_OSC >= 0) ? 1 : 0	};
 
+	// Vectorised butterflies, only for table-driven passes
+	const FFTRealSimd::PassFunction	simd_fnc =
+		(TRIGO_DIRECT == 0 && dist >= FFTRealSimd::MIN_DIST)
+		? FFTRealSimd::kernels ().pass
+		: 0;
+
 	long				coef_index = 0;
 	do
 	{
@@ -155,29 +169,36 @@ void	FFTRealPassDirect <PASS>::process (long len, DataType dest_ptr [], DataType
 		FFTRealUseTrigo <TRIGO_DIRECT>::prepare (osc_list [TRIGO_OSC]);
 
 		// Others are conjugate complex numbers
-		for (long i = 1; i < dist; ++ i)
+		if (simd_fnc != 0)
+		{
+			simd_fnc (df, sf, cos_ptr, dist, table_step);
+		}
+		else
 		{
-			DataType			c;
-			DataType			s;
-			FFTRealUseTrigo <TRIGO_DIRECT>::iterate (
-				osc_list [TRIGO_OSC],
-				c,
-				s,
-				cos_ptr,
-				i * table_step,
-				(dist - i) * table_step
-			);
-
-			const DataType	sf_r_i = sf [c1_r + i];
-			const DataType	sf_i_i = sf [c1_i + i];
-
-			const DataType	v1 = sf [c2_r + i] * c - sf [c2_i + i] * s;
-			df [c1_r + i] = sf_r_i + v1;
-			df [c2_r - i] = sf_r_i - v1;
-
-			const DataType	v2 = sf [c2_r + i] * s + sf [c2_i + i] * c;
-			df [c2_r + i] = v2 + sf_i_i;
-			df [cend - i] = v2 - sf_i_i;
+			for (long i = 1; i < dist; ++ i)
+			{
+				DataType			c;
+				DataType			s;
+				FFTRealUseTrigo <TRIGO_DIRECT>::iterate (
+					osc_list [TRIGO_OSC],
+					c,
+					s,
+					cos_ptr,
+					i * table_step,
+					(dist - i) * table_step
+				);
+
+				const DataType	sf_r_i = sf [c1_r + i];
+				const DataType	sf_i_i = sf [c1_i + i];
+
+				const DataType	v1 = sf [c2_r + i] * c - sf [c2_i + i] * s;
+				df [c1_r + i] = sf_r_i + v1;
+				df [c2_r - i] = sf_r_i - v1;
+
+				const DataType	v2 = sf [c2_r + i] * s + sf [c2_i + i] * c;
+				df [c2_r + i] = v2 + sf_i_i;
+				df [cend - i] = v2 - sf_i_i;
+			}
 		}
 
 		coef_index += cend;
@@ -38,8 +38,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 
 
-const double	PI		= 3.1415926535897932384626433832795;
-const double	SQRT2	= 1.41421356237309514547462185873883;
+constexpr double	PI		= 3.1415926535897932384626433832795;
+constexpr double	SQRT2	= 1.41421356237309514547462185873883;
 
 #if defined (_MSC_VER)
 
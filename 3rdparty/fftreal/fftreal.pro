@@ -12,6 +12,7 @@ HEADERS  += Array.h \
             FFTRealFixLen.h \
             FFTRealFixLen.hpp \
             FFTRealFixLenParam.h \
+            FFTRealLut.h \
             FFTRealPassDirect.h \
             FFTRealPassDirect.hpp \
             FFTRealPassInverse.h \
@@ -28,6 +29,10 @@ HEADERS  += Array.h \
 HEADERS  += fftreal_wrapper.h
 SOURCES  += fftreal_wrapper.cpp
 
+# Vectorised kernels for FFTRealPassDirect, picked at run time
+HEADERS  += fftreal_simd.h
+SOURCES  += fftreal_simd.cpp
+
 DEFINES  += FFTREAL_LIBRARY
 
 DESTDIR = ../..$${spectrum_build_dir}
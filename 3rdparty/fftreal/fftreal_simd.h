@@ -0,0 +1,43 @@
+#ifndef FFTREAL_SIMD_H
+#define FFTREAL_SIMD_H
+
+/**
+ * Vectorised kernels for the FFTRealPassDirect passes
+ *
+ * The kernels are compiled for SSE2 and AVX2 and picked once, on first
+ * use, according to the CPU.  A null kernel means that the scalar code of
+ * FFTRealPassDirect has to be used.  SSE2 is the default; the selection
+ * can be changed with the FFTREAL_SIMD environment variable set to
+ * "scalar", "sse2" or "avx2", which is useful to compare the paths.
+ */
+class FFTRealSimd
+{
+public:
+    typedef float DataType;
+
+    /**
+     * First and second pass at once: radix-4 butterflies on bit-reversed
+     * input.  len must be a multiple of 16.
+     */
+    typedef void (*Pass12Function)(long len, DataType dest_ptr[], const DataType x_ptr[], const long br_ptr[]);
+
+    /**
+     * Butterflies of one table-driven pass (the loop over i in
+     * FFTRealPassDirect<PASS>::process), for i in [1, dist).
+     */
+    typedef void (*PassFunction)(DataType df[], const DataType sf[], const DataType cos_ptr[], long dist, long table_step);
+
+    struct Kernels
+    {
+        const char *    name;
+        Pass12Function  pass_1_2;
+        PassFunction    pass;
+    };
+
+    // Passes shorter than this are left to the scalar code
+    enum { MIN_DIST = 8 };
+
+    static const Kernels &kernels();
+};
+
+#endif // FFTREAL_SIMD_H
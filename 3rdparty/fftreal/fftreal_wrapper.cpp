@@ -31,16 +31,56 @@
 
 #include "FFTRealFixLen.h"
 
+#include <cmath>
+
 class FFTRealWrapperPrivate {
 public:
-    FFTRealFixLen<FFTLengthPowerOfTwo> m_fft;
+    virtual ~FFTRealWrapperPrivate() { }
+    virtual void calculateFFT(FFTRealWrapper::DataType in[], const FFTRealWrapper::DataType out[]) = 0;
 };
 
+template <int LL2>
+class FFTRealWrapperPrivateFixLen : public FFTRealWrapperPrivate {
+public:
+    void calculateFFT(FFTRealWrapper::DataType in[], const FFTRealWrapper::DataType out[]) override
+    {
+        m_fft.do_fft(in, out);
+    }
+
+    FFTRealFixLen<LL2> m_fft;
+};
 
-FFTRealWrapper::FFTRealWrapper()
-    :   m_private(new FFTRealWrapperPrivate)
+template <int LL2>
+static FFTRealWrapperPrivate *createPrivate()
 {
+    return new FFTRealWrapperPrivateFixLen<LL2>;
+}
 
+// Dispatch table indexed by power of two - FFTLengthPowerOfTwoMin
+typedef FFTRealWrapperPrivate *(*FFTRealWrapperFactory)();
+static const FFTRealWrapperFactory factories[] = {
+    createPrivate<8>,
+    createPrivate<9>,
+    createPrivate<10>,
+    createPrivate<11>,
+    createPrivate<12>,
+    createPrivate<13>,
+    createPrivate<14>,
+    createPrivate<15>,
+    createPrivate<16>,
+    createPrivate<17>
+};
+
+static_assert(sizeof(factories) / sizeof(factories[0]) == FFTLengthPowerOfTwoInternalMax - FFTLengthPowerOfTwoMin + 1,
+              "FFT dispatch table does not cover the selectable range");
+
+
+FFTRealWrapper::FFTRealWrapper(int powerOfTwo)
+    :   m_private(nullptr)
+    ,   m_powerOfTwo(qBound(FFTLengthPowerOfTwoMin, powerOfTwo, FFTLengthPowerOfTwoInternalMax))
+{
+    Q_ASSERT(powerOfTwo == m_powerOfTwo);
+    m_private = factories[m_powerOfTwo - FFTLengthPowerOfTwoMin]();
 }
 
 FFTRealWrapper::~FFTRealWrapper()
@@ -50,5 +90,56 @@ FFTRealWrapper::~FFTRealWrapper()
 
 void FFTRealWrapper::calculateFFT(DataType in[], const DataType out[])
 {
-    m_private->m_fft.do_fft(in, out);
+    m_private->calculateFFT(in, out);
+}
+
+
+FFTRealStereoWrapper::FFTRealStereoWrapper(int powerOfTwo)
+    :   m_powerOfTwo(qBound(FFTLengthPowerOfTwoMin, powerOfTwo, FFTLengthPowerOfTwoMax))
+    ,   m_fft(m_powerOfTwo + 1)
+    ,   m_packed(2 << m_powerOfTwo)
+    ,   m_cos(1 << (m_powerOfTwo - 1))
+    ,   m_sin(1 << (m_powerOfTwo - 1))
+{
+    Q_ASSERT(powerOfTwo == m_powerOfTwo);
+    const int n = length();
+    for (int k = 0; k < n / 2; ++k)
+    {
+        const double angle = M_PI * k / n;
+        m_cos[k] = DataType(std::cos(angle));
+        m_sin[k] = DataType(std::sin(angle));
+    }
+}
+
+void FFTRealStereoWrapper::calculateFFT(DataType left[], DataType right[], const DataType interleaved[])
+{
+    const int n = length();
+    const int half = n / 2;
+    const DataType *y = m_packed.data();
+    m_fft.calculateFFT(m_packed.data(), interleaved);
+
+    // Y[m] for 0 < m < n is stored as y[m] + i y[n + m], with FFTReal's sign
+    // of the imaginary part; the identities hold unchanged in that convention
+    // once the twiddle is conjugated.
+    left[0] = DataType(0.5) * (y[0] + y[n]);
+    right[0] = DataType(0.5) * (y[0] - y[n]);
+
+    for (int k = 1; k < half; ++k)
+    {
+        const DataType pr = y[k];
+        const DataType pi = y[n + k];
+        const DataType qr = y[n - k];
+        const DataType qi = y[2 * n - k];
+
+        left[k] = DataType(0.5) * (pr + qr);
+        left[half + k] = DataType(0.5) * (pi - qi);
+
+        const DataType dr = pr - qr;
+        const DataType di = pi + qi;
+        right[k] = DataType(0.5) * (dr * m_cos[k] + di * m_sin[k]);
+        right[half + k] = DataType(0.5) * (di * m_cos[k] - dr * m_sin[k]);
+    }
+
+    left[half] = y[half];
+    right[half] = y[n + half];
 }
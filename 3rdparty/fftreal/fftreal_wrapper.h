@@ -20,6 +20,7 @@
 #ifndef FFTREAL_WRAPPER_H
 #define FFTREAL_WRAPPER_H
 
+#include <QtCore/QList>
 #include <QtCore/QtGlobal>
 
 class FFTRealWrapperPrivate;
@@ -28,29 +29,78 @@ class FFTRealWrapperPrivate;
 // number below.
 static const int FFTLengthPowerOfTwo = 12;
 
+// Range of X which can be selected at runtime
+static const int FFTLengthPowerOfTwoMin = 8;
+static const int FFTLengthPowerOfTwoMax = 16;
+
+// Largest transform built into the library, the stereo wrapper
+// transforms twice the selected length
+static const int FFTLengthPowerOfTwoInternalMax = FFTLengthPowerOfTwoMax + 1;
+
 /**
  * Wrapper around the FFTRealFixLen template provided by the FFTReal
  * library
  *
  * This class instantiates a single instance of FFTRealFixLen, using
- * FFTLengthPowerOfTwo as the template parameter.  It then exposes
- * FFTRealFixLen<FFTLengthPowerOfTwo>::do_fft via the calculateFFT
- * function, thereby allowing an application to dynamically link
- * against the FFTReal implementation.
+ * the requested power of two as the template parameter.  All the
+ * instantiations between FFTLengthPowerOfTwoMin and FFTLengthPowerOfTwoMax
+ * are built into the library and picked from a dispatch table when the
+ * wrapper is constructed, so calculateFFT does not branch on the length.
+ * It exposes FFTRealFixLen<N>::do_fft via the calculateFFT function,
+ * thereby allowing an application to dynamically link against the
+ * FFTReal implementation.
  *
  * See http://ldesoras.free.fr/prod.html
  */
 class FFTRealWrapper
 {
 public:
-    FFTRealWrapper();
+    explicit FFTRealWrapper(int powerOfTwo = FFTLengthPowerOfTwo);
     ~FFTRealWrapper();
 
     typedef float DataType;
     void calculateFFT(DataType in[], const DataType out[]);
 
+    int powerOfTwo() const { return m_powerOfTwo; }
+    int length() const { return 1 << m_powerOfTwo; }
+
 private:
     FFTRealWrapperPrivate*  m_private;
+    int                     m_powerOfTwo;
+};
+
+/**
+ * Two real transforms for the price of one
+ *
+ * Transforms an interleaved stereo buffer of 2N samples with a single
+ * real FFT of length 2N and separates the two N-point spectra using the
+ * conjugate symmetry of real signals:
+ *
+ *   Y[k] = L[k] + W^k R[k],  W = exp(-i pi / N)
+ *   L[k] = (Y[k] + conj(Y[N - k])) / 2
+ *   R[k] = (Y[k] - conj(Y[N - k])) / (2 W^k)
+ *
+ * The outputs use the same layout as FFTRealWrapper::calculateFFT for a
+ * transform of length N, so they can be used in place of two separate
+ * calls.
+ */
+class FFTRealStereoWrapper
+{
+public:
+    explicit FFTRealStereoWrapper(int powerOfTwo = FFTLengthPowerOfTwo);
+
+    typedef FFTRealWrapper::DataType DataType;
+    void calculateFFT(DataType left[], DataType right[], const DataType interleaved[]);
+
+    int powerOfTwo() const { return m_powerOfTwo; }
+    int length() const { return 1 << m_powerOfTwo; }
+
+private:
+    int                     m_powerOfTwo;
+    FFTRealWrapper          m_fft;
+    QList<DataType>         m_packed;
+    QList<DataType>         m_cos;
+    QList<DataType>         m_sin;
 };
 
 #endif // FFTREAL_WRAPPER_H
@@ -4,42 +4,22 @@ CONFIG += c++17
 
 #include(3rdparty/fftreal)
 
+include(analysis.pri)
+
 SOURCES += \
-    3rdparty/fftreal/fftreal_wrapper.cpp \
     3rdparty/fftreal/stopwatch/ClockCycleCounter.cpp \
     3rdparty/fftreal/stopwatch/StopWatch.cpp \
+    binningplan.cpp \
+    instancedspheres.cpp \
     main.cpp \
     mainwidget.cpp \
-    engine.cpp \
-    frequencyspectrum.cpp \
+    particlestore.cpp \
     spectrograph.cpp \
-    sphere.cpp \
-    scene.cpp \
-    spectrumanalyser.cpp \
-    utils.cpp
+    scene.cpp
 
 HEADERS += \
-    3rdparty/fftreal/Array.h \
-    3rdparty/fftreal/Array.hpp \
-    3rdparty/fftreal/DynArray.h \
-    3rdparty/fftreal/DynArray.hpp \
     3rdparty/fftreal/FFTReal.h \
     3rdparty/fftreal/FFTReal.hpp \
-    3rdparty/fftreal/FFTRealFixLen.h \
-    3rdparty/fftreal/FFTRealFixLen.hpp \
-    3rdparty/fftreal/FFTRealFixLenParam.h \
-    3rdparty/fftreal/FFTRealPassDirect.h \
-    3rdparty/fftreal/FFTRealPassDirect.hpp \
-    3rdparty/fftreal/FFTRealPassInverse.h \
-    3rdparty/fftreal/FFTRealPassInverse.hpp \
-    3rdparty/fftreal/FFTRealSelect.h \
-    3rdparty/fftreal/FFTRealSelect.hpp \
-    3rdparty/fftreal/FFTRealUseTrigo.h \
-    3rdparty/fftreal/FFTRealUseTrigo.hpp \
-    3rdparty/fftreal/OscSinCos.h \
-    3rdparty/fftreal/OscSinCos.hpp \
-    3rdparty/fftreal/def.h \
-    3rdparty/fftreal/fftreal_wrapper.h \
     3rdparty/fftreal/stopwatch/ClockCycleCounter.h \
     3rdparty/fftreal/stopwatch/ClockCycleCounter.hpp \
     3rdparty/fftreal/stopwatch/Int64.h \
@@ -51,14 +31,12 @@ HEADERS += \
     3rdparty/fftreal/test_fnc.h \
     3rdparty/fftreal/test_fnc.hpp \
     3rdparty/fftreal/test_settings.h \
+    binningplan.h \
+    instancedspheres.h \
     mainwidget.h \
-    engine.h \
-    frequencyspectrum.h \
+    particlestore.h \
     spectrograph.h \
-    sphere.h \
-    scene.h \
-    spectrumanalyser.h \
-    utils.h
+    scene.h
 
 TRANSLATIONS += \
     pro/AudioSpectrum_pl_PL.ts
@@ -74,6 +52,7 @@ SUBDIRS += \
     3rdparty/fftreal/fftreal.pro
 
 DISTFILES += \
+    analysis.pri \
     3rdparty/fftreal/CMakeLists.txt \
     3rdparty/fftreal/FFTReal.dsp \
     3rdparty/fftreal/FFTReal.dsw \
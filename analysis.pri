@@ -0,0 +1,73 @@
+# Capture and analysis core shared by the GUI and the headless analyser.
+# Needs only QtCore and QtMultimedia.
+
+QT += core multimedia
+
+CONFIG += c++17
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/3rdparty/fftreal/fftreal_simd.cpp \
+    $$PWD/3rdparty/fftreal/fftreal_wrapper.cpp \
+    $$PWD/engine.cpp \
+    $$PWD/frequencyspectrum.cpp \
+    $$PWD/spectrumanalyser.cpp \
+    $$PWD/utils.cpp \
+    $$PWD/ringbuffer.cpp \
+    $$PWD/audioprovider.cpp \
+    $$PWD/audiocapture.cpp \
+    $$PWD/fileplayback.cpp \
+    $$PWD/signalgenerator.cpp \
+    $$PWD/sampleconversion.cpp \
+    $$PWD/fftbenchmark.cpp \
+    $$PWD/spectrumcalculator.cpp \
+    $$PWD/spectrumkernels.cpp \
+    $$PWD/windowfunction.cpp \
+    $$PWD/constantq.cpp \
+    $$PWD/spectrumbuffer.cpp \
+    $$PWD/wavfile.cpp \
+    $$PWD/fileanalyser.cpp \
+    $$PWD/analysisoptions.cpp
+
+HEADERS += \
+    $$PWD/3rdparty/fftreal/Array.h \
+    $$PWD/3rdparty/fftreal/Array.hpp \
+    $$PWD/3rdparty/fftreal/DynArray.h \
+    $$PWD/3rdparty/fftreal/DynArray.hpp \
+    $$PWD/3rdparty/fftreal/FFTRealFixLen.h \
+    $$PWD/3rdparty/fftreal/FFTRealFixLen.hpp \
+    $$PWD/3rdparty/fftreal/FFTRealFixLenParam.h \
+    $$PWD/3rdparty/fftreal/FFTRealLut.h \
+    $$PWD/3rdparty/fftreal/FFTRealPassDirect.h \
+    $$PWD/3rdparty/fftreal/FFTRealPassDirect.hpp \
+    $$PWD/3rdparty/fftreal/FFTRealPassInverse.h \
+    $$PWD/3rdparty/fftreal/FFTRealPassInverse.hpp \
+    $$PWD/3rdparty/fftreal/FFTRealSelect.h \
+    $$PWD/3rdparty/fftreal/FFTRealSelect.hpp \
+    $$PWD/3rdparty/fftreal/FFTRealUseTrigo.h \
+    $$PWD/3rdparty/fftreal/FFTRealUseTrigo.hpp \
+    $$PWD/3rdparty/fftreal/OscSinCos.h \
+    $$PWD/3rdparty/fftreal/OscSinCos.hpp \
+    $$PWD/3rdparty/fftreal/def.h \
+    $$PWD/3rdparty/fftreal/fftreal_simd.h \
+    $$PWD/3rdparty/fftreal/fftreal_wrapper.h \
+    $$PWD/engine.h \
+    $$PWD/frequencyspectrum.h \
+    $$PWD/spectrumanalyser.h \
+    $$PWD/utils.h \
+    $$PWD/ringbuffer.h \
+    $$PWD/audioprovider.h \
+    $$PWD/audiocapture.h \
+    $$PWD/fileplayback.h \
+    $$PWD/signalgenerator.h \
+    $$PWD/sampleconversion.h \
+    $$PWD/fftbenchmark.h \
+    $$PWD/spectrumcalculator.h \
+    $$PWD/spectrumkernels.h \
+    $$PWD/windowfunction.h \
+    $$PWD/constantq.h \
+    $$PWD/spectrumbuffer.h \
+    $$PWD/wavfile.h \
+    $$PWD/fileanalyser.h \
+    $$PWD/analysisoptions.h
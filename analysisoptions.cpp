@@ -0,0 +1,102 @@
+#include "analysisoptions.h"
+
+bool AnalysisOptions::parse(const QStringList &arguments)
+{
+    errorString.clear();
+
+    for (int i = 1; i < arguments.count(); ++i)
+    {
+        const QString &argument = arguments.at(i);
+        const bool hasValue = i + 1 < arguments.count();
+
+        if (argument == QStringLiteral("--"))
+        {
+            break;
+        }
+        else if (argument == QStringLiteral("--fft-size") && hasValue)
+        {
+            const int samples = arguments.at(++i).toInt();
+            int powerOfTwo = 0;
+            while ((2 << powerOfTwo) <= samples)
+            {
+                ++powerOfTwo;
+            }
+            fftLengthPowerOfTwo = powerOfTwo;
+        }
+        else if (argument == QStringLiteral("--hop-size") && hasValue)
+        {
+            hopSize = qMax(arguments.at(++i).toInt(), 0);
+        }
+        else if (argument == QStringLiteral("--db-scale"))
+        {
+            scale.mode = AmplitudeScale::Decibel;
+        }
+        else if (argument == QStringLiteral("--db-floor") && hasValue)
+        {
+            scale.floor = arguments.at(++i).toFloat();
+        }
+        else if (argument == QStringLiteral("--db-ceiling") && hasValue)
+        {
+            scale.ceiling = arguments.at(++i).toFloat();
+        }
+        else if (argument == QStringLiteral("--window") && hasValue)
+        {
+            bool ok = false;
+            const WindowFunction::Type type = WindowFunction::typeFromName(arguments.at(++i), &ok);
+            if (ok)
+            {
+                window.type = type;
+            }
+            else if (errorString.isEmpty())
+            {
+                errorString = QStringLiteral("unknown window ") + arguments.at(i);
+            }
+        }
+        else if (argument == QStringLiteral("--window-parameter") && hasValue)
+        {
+            window.parameter = arguments.at(++i).toFloat();
+        }
+        else if (argument == QStringLiteral("--stereo-packing"))
+        {
+            stereoPacking = true;
+        }
+        else if (argument == QStringLiteral("--instantaneous-frequency"))
+        {
+            instantaneousFrequency = true;
+        }
+        else if (argument == QStringLiteral("--constant-q") && hasValue)
+        {
+            constantQBands = qMax(arguments.at(++i).toInt(), 0);
+        }
+        else if (argument == QStringLiteral("--analysis-threads") && hasValue)
+        {
+            analysisThreads = qMax(arguments.at(++i).toInt(), 0);
+        }
+        else if (argument == QStringLiteral("--generator") && hasValue)
+        {
+            bool ok = false;
+            const SignalGenerator::Waveform waveform = SignalGenerator::waveformFromName(arguments.at(++i), &ok);
+            if (ok)
+            {
+                useGenerator = true;
+                generator = waveform;
+                playFile.clear();
+            }
+            else if (errorString.isEmpty())
+            {
+                errorString = QStringLiteral("unknown generator ") + arguments.at(i);
+            }
+        }
+        else if (argument == QStringLiteral("--play-file") && hasValue)
+        {
+            playFile = arguments.at(++i);
+            useGenerator = false;
+        }
+        else if (argument == QStringLiteral("--speed") && hasValue)
+        {
+            speed = arguments.at(++i).toDouble();
+        }
+    }
+
+    return errorString.isEmpty();
+}
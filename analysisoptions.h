@@ -0,0 +1,63 @@
+#ifndef ANALYSISOPTIONS_H
+#define ANALYSISOPTIONS_H
+
+#include <QString>
+#include <QStringList>
+
+#include "signalgenerator.h"
+#include "spectrumkernels.h"
+#include "windowfunction.h"
+
+/*!
+ * \brief Analysis settings read from the command line
+ *
+ * Shared by the GUI, the headless analyser and Engine, so that every option is
+ * parsed in one place. Options after "--" are ignored.
+ *
+ * --fft-size <samples>       FFT length, rounded down to a power of two
+ * --hop-size <samples>       distance between frames
+ * --db-scale                 decibel instead of logarithmic amplitude scale
+ * --db-floor <dB>            level shown as 0.0 with --db-scale
+ * --db-ceiling <dB>          level shown as 1.0 with --db-scale
+ * --window <name>            window type, see WindowFunction::typeFromName
+ * --window-parameter <x>     parameter of the window
+ * --stereo-packing           both channels in one complex FFT
+ * --instantaneous-frequency  reassigned peak frequencies
+ * --constant-q <bands>       constant-Q bands instead of FFT bins
+ * --analysis-threads <n>     number of FFT worker threads
+ * --generator <signal>       synthetic input, see SignalGenerator::waveformFromName
+ * --play-file <file>         looped WAV file as input
+ * --speed <factor>           pace of --generator and --play-file
+ */
+struct AnalysisOptions
+{
+    int             fftLengthPowerOfTwo = 0;    // 0 if not given
+    int             hopSize = 0;                // 0 if not given
+    AmplitudeScale  scale;
+    WindowFunction  window;
+    bool            stereoPacking = false;
+    bool            instantaneousFrequency = false;
+    int             constantQBands = 0;         // 0 if not given
+    int             analysisThreads = 0;        // 0 if not given
+    bool            useGenerator = false;
+    SignalGenerator::Waveform generator = SignalGenerator::Sweep;
+    QString         playFile;
+    double          speed = 1.0;
+
+    /*!
+     * \brief Reason of the last failed parse()
+     */
+    QString         errorString;
+
+    /*!
+     * \brief Reads the options from the command line
+     *
+     * Unknown arguments are skipped. An unknown window or generator name leaves the
+     * default in place and makes the call fail, after all other options have been read.
+     * \param[in] arguments - command line, the first one being the program
+     * \return If all names were known
+     */
+    bool parse(const QStringList &arguments);
+};
+
+#endif // ANALYSISOPTIONS_H
@@ -0,0 +1,99 @@
+#include "audiocapture.h"
+#include "ringbuffer.h"
+
+#include <QAudioSource>
+
+AudioCapture::AudioCapture(QObject *parent)
+    :   AudioProvider(parent)
+    ,   m_audioInput(nullptr)
+    ,   m_audioInputIODevice(nullptr)
+{
+}
+
+AudioCapture::~AudioCapture()
+{
+    stop();
+}
+
+//-----------------------------------------------------------------------------
+// Public slots
+//-----------------------------------------------------------------------------
+
+void AudioCapture::start(const QAudioFormat &format)
+{
+    stop();
+
+    clearRingBuffer();
+
+    m_audioInput = new QAudioSource(m_device, format, this);
+    connect(m_audioInput, &QAudioSource::stateChanged,
+            this, &AudioCapture::stateChanged);
+
+    m_audioInputIODevice = m_audioInput->start();
+    connect(m_audioInputIODevice, &QIODevice::readyRead,
+            this, &AudioCapture::audioDataReady);
+}
+
+void AudioCapture::stop()
+{
+    if (m_audioInput)
+    {
+        m_audioInput->stop();
+        m_audioInput->disconnect();
+        delete m_audioInput;
+        m_audioInput = nullptr;
+    }
+    m_audioInputIODevice = nullptr;
+}
+
+void AudioCapture::suspend()
+{
+    if (m_audioInput)
+    {
+        m_audioInput->suspend();
+    }
+}
+
+void AudioCapture::resume()
+{
+    if (m_audioInput)
+    {
+        m_audioInput->resume();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Private slots
+//-----------------------------------------------------------------------------
+
+void AudioCapture::audioDataReady()
+{
+    if (!m_audioInputIODevice)
+    {
+        return;
+    }
+
+    qint64 bytesReady = m_audioInput->bytesAvailable();
+    bool written = false;
+
+    // Read straight into the ring, the region may be split at the end of it
+    while (bytesReady > 0)
+    {
+        qint64 bytesToRead = 0;
+        char *region = m_ringBuffer->beginWrite(bytesReady, &bytesToRead);
+        const qint64 bytesRead = m_audioInputIODevice->read(region, bytesToRead);
+        if (bytesRead <= 0)
+        {
+            m_ringBuffer->endWrite(0);
+            break;
+        }
+        m_ringBuffer->endWrite(bytesRead);
+        bytesReady -= bytesRead;
+        written = true;
+    }
+
+    if (written)
+    {
+        notify();
+    }
+}
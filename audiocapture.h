@@ -0,0 +1,75 @@
+#ifndef AUDIOCAPTURE_H
+#define AUDIOCAPTURE_H
+
+#include "audioprovider.h"
+
+#include <QAudioDevice>
+
+QT_BEGIN_NAMESPACE
+class QAudioSource;
+class QIODevice;
+QT_END_NAMESPACE
+
+/*!
+ * \brief AudioCapture Class
+ *
+ * Drains the audio device into the ring buffer. The object is meant to live in its own
+ * high priority thread, so that slow painting in the GUI thread cannot delay reading
+ * the device. The format is negotiated with the device by Engine.
+ */
+class AudioCapture : public AudioProvider
+{
+    Q_OBJECT
+
+public:
+    explicit AudioCapture(QObject *parent = nullptr);
+    ~AudioCapture();
+
+    QAudioFormat format() const override { return QAudioFormat(); }
+
+    /*!
+     * \brief Sets the device opened by the next start
+     *
+     * \param[in] device - audio device
+     */
+    void setDevice(const QAudioDevice &device) { m_device = device; }
+
+public slots:
+
+    /*!
+     * \brief Clears the ring buffer and starts capturing from the device
+     *
+     * \param[in] format - format of the captured audio
+     */
+    void start(const QAudioFormat &format) override;
+
+    /*!
+     * \brief Stops capturing and releases the device
+     */
+    void stop() override;
+
+    /*!
+     * \brief Stops taking data from the device
+     */
+    void suspend() override;
+
+    /*!
+     * \brief Continues taking data from the device after suspend
+     */
+    void resume() override;
+
+private slots:
+
+    /*!
+     * \brief Method for reading audio data
+     */
+    void audioDataReady();
+
+private:
+
+    QAudioDevice        m_device;
+    QAudioSource*       m_audioInput;
+    QIODevice*          m_audioInputIODevice;
+};
+
+#endif // AUDIOCAPTURE_H
@@ -0,0 +1,202 @@
+#include "audioprovider.h"
+#include "ringbuffer.h"
+
+#include <QTimer>
+
+//-----------------------------------------------------------------------------
+// Constants
+//-----------------------------------------------------------------------------
+
+// Period of the paced providers, about the period of a sound card
+const int PacingIntervalMs = 10;
+
+// Frames written per acknowledged block by an unthrottled provider
+const qint64 UnthrottledBlockFrames = 4096;
+
+//=============================================================================
+// AudioProvider
+//=============================================================================
+
+AudioProvider::AudioProvider(QObject *parent)
+    :   QObject(parent)
+    ,   m_ringBuffer(nullptr)
+    ,   m_notifyPending(false)
+{
+}
+
+AudioProvider::~AudioProvider() = default;
+
+void AudioProvider::acknowledge()
+{
+    m_notifyPending.store(false, std::memory_order_release);
+    acknowledged();
+}
+
+void AudioProvider::clearRingBuffer()
+{
+    m_ringBuffer->clear();
+    m_notifyPending.store(false, std::memory_order_relaxed);
+}
+
+void AudioProvider::notify()
+{
+    // Notify only once until the consumer catches up, so a stalled GUI thread
+    // does not pile up events
+    if (!m_notifyPending.exchange(true, std::memory_order_acq_rel))
+    {
+        emit dataAvailable();
+    }
+}
+
+//=============================================================================
+// PacedAudioProvider
+//=============================================================================
+
+PacedAudioProvider::PacedAudioProvider(QObject *parent)
+    :   AudioProvider(parent)
+    ,   m_speed(1.0)
+    ,   m_active(false)
+    ,   m_unthrottled(false)
+    ,   m_timer(new QTimer(this))
+    ,   m_framesProduced(0)
+    ,   m_bytesPerFrame(0)
+    ,   m_sampleRate(0)
+{
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &PacedAudioProvider::tick);
+}
+
+PacedAudioProvider::~PacedAudioProvider() = default;
+
+//-----------------------------------------------------------------------------
+// Public slots
+//-----------------------------------------------------------------------------
+
+void PacedAudioProvider::start(const QAudioFormat &format)
+{
+    stop();
+
+    clearRingBuffer();
+    rewind();
+
+    m_bytesPerFrame = format.bytesPerFrame();
+    m_sampleRate = format.sampleRate();
+    if (0 == m_bytesPerFrame || 0 == m_sampleRate)
+    {
+        emit stateChanged(QAudio::StoppedState);
+        return;
+    }
+
+    resume();
+}
+
+void PacedAudioProvider::stop()
+{
+    if (m_active || 0 != m_bytesPerFrame)
+    {
+        m_active = false;
+        m_unthrottled.store(false, std::memory_order_release);
+        m_timer->stop();
+        m_bytesPerFrame = 0;
+        emit stateChanged(QAudio::StoppedState);
+    }
+}
+
+void PacedAudioProvider::suspend()
+{
+    if (m_active)
+    {
+        m_active = false;
+        m_unthrottled.store(false, std::memory_order_release);
+        m_timer->stop();
+        emit stateChanged(QAudio::SuspendedState);
+    }
+}
+
+void PacedAudioProvider::resume()
+{
+    if (0 == m_bytesPerFrame || m_active)
+    {
+        return;
+    }
+    m_active = true;
+    emit stateChanged(QAudio::ActiveState);
+
+    if (m_speed > 0.0)
+    {
+        // The pace is measured from here, so a pause is not caught up with a burst
+        m_framesProduced = 0;
+        m_clock.start();
+        m_timer->start(PacingIntervalMs);
+    }
+    else
+    {
+        // Each acknowledgement asks for the next block, this one starts the chain
+        m_unthrottled.store(true, std::memory_order_release);
+        produceBlock();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Protected functions
+//-----------------------------------------------------------------------------
+
+void PacedAudioProvider::acknowledged()
+{
+    // Called in the consumer thread, the block is produced in the provider thread
+    if (m_unthrottled.load(std::memory_order_acquire))
+    {
+        QMetaObject::invokeMethod(this, &PacedAudioProvider::produceBlock, Qt::QueuedConnection);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Private slots
+//-----------------------------------------------------------------------------
+
+void PacedAudioProvider::tick()
+{
+    // Derived from the clock rather than counted in ticks, so timer jitter does not add up
+    const qint64 framesDue = qint64(double(m_clock.nsecsElapsed()) * 1e-9 * m_sampleRate * m_speed);
+    produce(framesDue - m_framesProduced);
+}
+
+void PacedAudioProvider::produceBlock()
+{
+    // A block queued before suspend or stop, or one still unread, is dropped
+    if (m_unthrottled.load(std::memory_order_acquire) && !isNotifyPending())
+    {
+        produce(UnthrottledBlockFrames);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Private functions
+//-----------------------------------------------------------------------------
+
+void PacedAudioProvider::produce(qint64 frameCount)
+{
+    if (frameCount <= 0)
+    {
+        return;
+    }
+    m_framesProduced += frameCount;
+
+    // The region may be split at the end of the ring
+    while (frameCount > 0)
+    {
+        qint64 regionLength = 0;
+        char *region = m_ringBuffer->beginWrite(frameCount * m_bytesPerFrame, &regionLength);
+        const qint64 regionFrames = regionLength / m_bytesPerFrame;
+        if (0 == regionFrames)
+        {
+            m_ringBuffer->endWrite(0);
+            break;
+        }
+        render(region, regionFrames);
+        m_ringBuffer->endWrite(regionFrames * m_bytesPerFrame);
+        frameCount -= regionFrames;
+    }
+
+    notify();
+}
@@ -0,0 +1,209 @@
+#ifndef AUDIOPROVIDER_H
+#define AUDIOPROVIDER_H
+
+#include <QAudio>
+#include <QAudioFormat>
+#include <QElapsedTimer>
+#include <QObject>
+
+#include <atomic>
+
+class RingBuffer;
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+/*!
+ * \brief AudioProvider Class
+ *
+ * Source of the audio consumed by Engine. A provider lives in the capture thread and
+ * writes interleaved frames into the ring buffer; the consumer is only told that new
+ * data is available, at most once until it acknowledges the notification.
+ */
+class AudioProvider : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AudioProvider(QObject *parent = nullptr);
+    ~AudioProvider();
+
+    /*!
+     * \brief Sets the ring buffer written by the provider
+     *
+     * Must not be called while the provider is started.
+     * \param[in] ringBuffer - destination of the frames
+     */
+    void setRingBuffer(RingBuffer *ringBuffer) { m_ringBuffer = ringBuffer; }
+
+    /*!
+     * \brief Format of the frames produced by the provider
+     *
+     * \param[out] QAudioFormat - fixed format, or an invalid format if the provider
+     * takes the one negotiated by Engine with the audio device
+     */
+    virtual QAudioFormat format() const = 0;
+
+    /*!
+     * \brief Acknowledges the last dataAvailable notification
+     *
+     * Called by the consumer before it reads the ring buffer. May be called from any thread.
+     */
+    void acknowledge();
+
+public slots:
+
+    /*!
+     * \brief Clears the ring buffer and starts producing frames
+     *
+     * \param[in] format - format of the frames
+     */
+    virtual void start(const QAudioFormat &format) = 0;
+
+    /*!
+     * \brief Stops producing frames
+     */
+    virtual void stop() = 0;
+
+    /*!
+     * \brief Pauses producing frames
+     */
+    virtual void suspend() = 0;
+
+    /*!
+     * \brief Continues producing frames after suspend
+     */
+    virtual void resume() = 0;
+
+signals:
+
+    /*!
+     * \brief New data has been written to the ring buffer
+     */
+    void dataAvailable();
+
+    /*!
+     * \brief State of the provider has changed
+     *
+     * \param[in] state - new state
+     */
+    void stateChanged(QAudio::State state);
+
+protected:
+
+    /*!
+     * \brief Rewinds the ring buffer and the notification before starting
+     */
+    void clearRingBuffer();
+
+    /*!
+     * \brief Emits dataAvailable unless the previous notification is still pending
+     */
+    void notify();
+
+    /*!
+     * \brief Checks if the consumer has not acknowledged the last notification yet
+     */
+    bool isNotifyPending() const { return m_notifyPending.load(std::memory_order_acquire); }
+
+    /*!
+     * \brief Called by acknowledge() once the notification is cleared
+     *
+     * Runs in the thread of the consumer; the default does nothing.
+     */
+    virtual void acknowledged() {}
+
+    RingBuffer*         m_ringBuffer;
+
+private:
+
+    std::atomic<bool>   m_notifyPending;
+};
+
+/*!
+ * \brief PacedAudioProvider Class
+ *
+ * Base of the providers that synthesise or read frames instead of taking them from a
+ * device. Frames are produced on a timer, at real-time rate multiplied by the speed.
+ * A speed of 0 produces a block whenever the consumer has acknowledged the previous
+ * one, i.e. as fast as the pipeline takes it; the acknowledgement queues the next
+ * block into the provider thread, so no timer spins while the consumer is busy.
+ */
+class PacedAudioProvider : public AudioProvider
+{
+    Q_OBJECT
+
+public:
+    explicit PacedAudioProvider(QObject *parent = nullptr);
+    ~PacedAudioProvider();
+
+    /*!
+     * \brief Sets the playback speed
+     *
+     * \param[in] speed - multiple of real time, 0 for unthrottled
+     */
+    void setSpeed(double speed) { m_speed = qMax(0.0, speed); }
+
+    /*!
+     * \brief Returns the playback speed
+     */
+    double speed() const { return m_speed; }
+
+public slots:
+
+    void start(const QAudioFormat &format) override;
+    void stop() override;
+    void suspend() override;
+    void resume() override;
+
+protected:
+
+    void acknowledged() override;
+
+    /*!
+     * \brief Rewinds the source to its first frame
+     *
+     * Called on start, so every run produces the same stream.
+     */
+    virtual void rewind() = 0;
+
+    /*!
+     * \brief Writes the next frames of the source
+     *
+     * \param[out] data - destination of frameCount frames in format()
+     * \param[in] frameCount - number of frames to write
+     */
+    virtual void render(char *data, qint64 frameCount) = 0;
+
+private slots:
+
+    /*!
+     * \brief Produces the frames due since the last tick
+     */
+    void tick();
+
+    /*!
+     * \brief Produces one block of an unthrottled provider
+     */
+    void produceBlock();
+
+private:
+
+    /*!
+     * \brief Renders frames straight into the ring buffer
+     *
+     * \param[in] frameCount - number of frames
+     */
+    void produce(qint64 frameCount);
+
+    double              m_speed;
+    bool                m_active;
+    std::atomic<bool>   m_unthrottled;
+    QTimer*             m_timer;
+    QElapsedTimer       m_clock;
+    qint64              m_framesProduced;
+    int                 m_bytesPerFrame;
+    int                 m_sampleRate;
+};
+
+#endif // AUDIOPROVIDER_H
@@ -0,0 +1,150 @@
+#include "binningplan.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <cmath>
+
+BinningPlan::BinningPlan()
+    :   m_numBars(0)
+    ,   m_lowFreq(0.0)
+    ,   m_highFreq(0.0)
+    ,   m_upperFreq(0.0)
+    ,   m_frequencies(nullptr)
+    ,   m_dirty(true)
+    ,   m_firstBin(0)
+{
+}
+
+void BinningPlan::setBars(int numBars, qreal lowFreq, qreal highFreq, qreal upperFreq)
+{
+    Q_ASSERT(numBars > 0);
+    Q_ASSERT(highFreq > lowFreq);
+    m_numBars = numBars;
+    m_lowFreq = lowFreq;
+    m_highFreq = highFreq;
+    m_upperFreq = upperFreq;
+    m_dirty = true;
+}
+
+void BinningPlan::update(const FrequencySpectrum &spectrum)
+{
+    if (m_dirty || spectrum.frequencies() != m_frequencies)
+    {
+        m_frequencies = spectrum.frequencies();
+        build(m_frequencies, spectrum.size());
+        m_dirty = false;
+    }
+}
+
+void BinningPlan::build(const float *frequencies, int numBins)
+{
+    m_firstBin = 0;
+    m_barIndex.clear();
+    m_edges.clear();
+
+    // The axis is ascending, so the bins in range form one contiguous interval
+    int lastBin = -1;
+    for (int i = 0; i < numBins; ++i)
+    {
+        if (frequencies[i] >= m_lowFreq && frequencies[i] < m_highFreq)
+        {
+            if (lastBin < 0)
+            {
+                m_firstBin = i;
+            }
+            lastBin = i + 1;
+        }
+    }
+    if (lastBin < 0 || m_numBars <= 0)
+    {
+        return;
+    }
+
+    // The first bin in range sets the left edge of the first bar
+    const qreal logLower = std::log(qreal(frequencies[m_firstBin]));
+    const qreal barsPerLog = m_numBars / (std::log(m_upperFreq) - logLower);
+
+    m_barIndex.resize(lastBin - m_firstBin);
+    for (int i = m_firstBin; i < lastBin; ++i)
+    {
+        const int index = int(std::floor((std::log(qreal(frequencies[i])) - logLower) * barsPerLog));
+        m_barIndex[i - m_firstBin] = qBound(0, index, m_numBars - 1);
+    }
+
+    m_edges.resize(m_numBars + 1);
+    for (int bar = 0; bar <= m_numBars; ++bar)
+    {
+        m_edges[bar] = float(std::exp(logLower + bar / barsPerLog));
+    }
+}
+
+int BinningPlan::nearbyBar(int bar, float frequency) const
+{
+    while (bar + 1 < m_numBars && frequency >= m_edges[bar + 1])
+    {
+        ++bar;
+    }
+    while (bar > 0 && frequency < m_edges[bar])
+    {
+        --bar;
+    }
+    return bar;
+}
+
+void BinningPlan::maxPerBar(const float *amplitudes, const float *instantaneousFrequencies, float *values) const
+{
+    std::fill(values, values + m_numBars, 0.0f);
+
+    const int numBins = m_barIndex.count();
+    if (0 == numBins)
+    {
+        return;
+    }
+
+    const int *barIndex = m_barIndex.constData();
+    amplitudes += m_firstBin;
+
+    if (instantaneousFrequencies)
+    {
+        // The instantaneous frequency lies near the bin centre, so moving to the neighbouring bars is enough
+        instantaneousFrequencies += m_firstBin;
+        const float lower = m_edges.first();
+        for (int i = 0; i < numBins; ++i)
+        {
+            int bar = barIndex[i];
+            const float frequency = instantaneousFrequencies[i];
+            if (frequency >= lower && frequency < m_highFreq)
+            {
+                bar = nearbyBar(bar, frequency);
+            }
+            values[bar] = qMax(values[bar], amplitudes[i]);
+        }
+        return;
+    }
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        float &value = values[barIndex[i]];
+        value = qMax(value, amplitudes[i]);
+    }
+}
+
+void BinningPlan::clippedBars(const quint32 *clipMask, bool *clipped) const
+{
+    // Only the set bits, clipping is rare
+    const int lastBin = m_firstBin + m_barIndex.count();
+    for (int word = m_firstBin / 32; word * 32 < lastBin; ++word)
+    {
+        quint32 bits = clipMask[word];
+        while (bits)
+        {
+            const int bin = word * 32 + qCountTrailingZeroBits(bits);
+            bits &= bits - 1;
+            if (bin >= m_firstBin && bin < lastBin)
+            {
+                clipped[m_barIndex[bin - m_firstBin]] = true;
+            }
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef BINNINGPLAN_H
+#define BINNINGPLAN_H
+
+#include "frequencyspectrum.h"
+
+#include <QList>
+
+/*!
+ * \brief Klasa BinningPlan
+ *
+ * Przyporządkowanie prążków FFT lub pasm stałego Q do pasków wykresu w skali logarytmicznej.
+ * Indeksy pasków zależą tylko od liczby pasków, zakresu częstotliwości i osi częstotliwości
+ * widma, więc są liczone raz, przy zmianie parametrów lub osi, a każda klatka sprowadza się
+ * do jednego przejścia po prążkach bez logarytmów.
+ */
+class BinningPlan
+{
+public:
+    BinningPlan();
+
+    /*!
+     * \brief Ustawienie parametrów pasków
+     *
+     * Plan zostanie przeliczony przy następnym wywołaniu update.
+     * \param[in] numBars - liczba pasków
+     * \param[in] lowFreq - najniższa wyświetlana częstotliwość
+     * \param[in] highFreq - górna granica wyświetlanych częstotliwości
+     * \param[in] upperFreq - częstotliwość prawej krawędzi ostatniego paska
+     */
+    void setBars(int numBars, qreal lowFreq, qreal highFreq, qreal upperFreq);
+
+    /*!
+     * \brief Dopasowanie planu do widma
+     *
+     * Przelicza plan tylko gdy zmieniła się oś częstotliwości widma. Osie są współdzielone
+     * i trzymane do końca działania programu, więc wystarczy porównać ich adresy.
+     * \param[in] spectrum - widmo, które będzie rozkładane na paski
+     */
+    void update(const FrequencySpectrum &spectrum);
+
+    /*!
+     * \brief Liczba pasków
+     */
+    int barCount() const { return m_numBars; }
+
+    /*!
+     * \brief Maksymalna amplituda w każdym pasku
+     *
+     * \param[in] amplitudes - amplitudy prążków widma, dla którego wywołano update
+     * \param[in] instantaneousFrequencies - częstotliwości chwilowe prążków lub nullptr;
+     *            prążek trafia wtedy do paska swojej częstotliwości chwilowej
+     * \param[out] values - barCount() wartości pasków, paski bez prążków mają 0
+     */
+    void maxPerBar(const float *amplitudes, const float *instantaneousFrequencies, float *values) const;
+
+    /*!
+     * \brief Zaznaczenie pasków z przesterowanymi prążkami
+     *
+     * \param[in] clipMask - maska przesterowania widma, dla którego wywołano update
+     * \param[out] clipped - barCount() flag, ustawiane tylko na true
+     */
+    void clippedBars(const quint32 *clipMask, bool *clipped) const;
+
+private:
+
+    /*!
+     * \brief Przeliczenie indeksów pasków dla osi częstotliwości
+     *
+     * \param[in] frequencies - częstotliwości prążków, rosnąco
+     * \param[in] numBins - liczba prążków
+     */
+    void build(const float *frequencies, int numBins);
+
+    /*!
+     * \brief Pasek częstotliwości w pobliżu paska prążka
+     *
+     * \param[in] bar - pasek, od którego zaczyna się szukanie
+     * \param[in] frequency - częstotliwość
+     * \param[out] int - pasek, do którego należy częstotliwość
+     */
+    int nearbyBar(int bar, float frequency) const;
+
+    int                 m_numBars;
+    qreal               m_lowFreq;
+    qreal               m_highFreq;
+    qreal               m_upperFreq;
+
+    const float*        m_frequencies;
+    bool                m_dirty;
+
+    int                 m_firstBin;
+    QList<int>          m_barIndex;     // bar of every bin from m_firstBin
+    QList<float>        m_edges;        // left edges of the bars and the right edge of the last one
+};
+
+#endif // BINNINGPLAN_H
@@ -0,0 +1,146 @@
+#include "constantq.h"
+
+#include <QHash>
+#include <QMutex>
+#include <qmath.h>
+
+#include <cstring>
+
+// Coefficients below -45 dB of the peak of a band are dropped, as in Brown & Puckette
+const double KernelThreshold = 0.0054;
+
+// Bins searched on each side of the centre of a band, in main lobe half widths
+const double KernelSearchWidth = 3.0;
+
+/*!
+ * \brief sin(L x / 2) / sin(x / 2), the amplitude of the DTFT of L ones
+ */
+static double dirichlet(double x, int length)
+{
+    const double denominator = std::sin(0.5 * x);
+    if (qAbs(denominator) < 1e-12)
+    {
+        return length;
+    }
+    return std::sin(0.5 * length * x) / denominator;
+}
+
+ConstantQKernel::ConstantQKernel(int fftLength, int sampleRate, int bands, float lowFreq, float highFreq)
+    :   m_fftLength(fftLength)
+    ,   m_sampleRate(sampleRate)
+{
+    const int half = fftLength / 2;
+    const double logRatio = std::log(double(highFreq) / lowFreq);
+    const double q = 1.0 / (std::exp(logRatio / bands) - 1.0);
+
+    m_frequencies.resize(bands);
+    m_firstBin.resize(bands);
+    m_offset.resize(bands + 1);
+
+    QList<double> amplitude;
+    m_offset[0] = 0;
+    for (int band = 0; band < bands; ++band)
+    {
+        const double frequency = lowFreq * std::exp(logRatio * (band + 0.5) / bands);
+        m_frequencies[band] = float(frequency);
+
+        // Q periods of the centre frequency, at most the whole frame
+        const int length = qBound(4, qRound(q * sampleRate / frequency), fftLength);
+        const int start = (fftLength - length) / 2;
+        const double omega = 2.0 * M_PI * frequency / sampleRate;
+        const double alpha = 2.0 * M_PI / (length - 1);
+
+        // The DTFT of the symmetric Hann window is a sum of three Dirichlet kernels
+        // with a common linear phase; its peak is the sum of the window, (L - 1) / 2.
+        const double peak = 0.5 * (length - 1);
+        const double centre = frequency * fftLength / sampleRate;
+        const double reach = KernelSearchWidth * 2.0 * fftLength / length + 2.0;
+        const int lower = qMax(1, int(std::floor(centre - reach)));
+        const int upper = qMin(half - 1, int(std::ceil(centre + reach)));
+
+        amplitude.resize(qMax(0, upper - lower + 1));
+        int first = upper + 1;
+        int last = lower - 1;
+        for (int j = lower; j <= upper; ++j)
+        {
+            const double theta = omega - 2.0 * M_PI * j / fftLength;
+            const double value = 0.5 * dirichlet(theta, length)
+                               + 0.25 * dirichlet(theta - alpha, length)
+                               + 0.25 * dirichlet(theta + alpha, length);
+            amplitude[j - lower] = value;
+            if (qAbs(value) >= KernelThreshold * peak)
+            {
+                first = qMin(first, j);
+                last = j;
+            }
+        }
+
+        // Frame centred window: phase of the frame offset and of the window centre
+        m_firstBin[band] = first;
+        for (int j = first; j <= last; ++j)
+        {
+            const double theta = omega - 2.0 * M_PI * j / fftLength;
+            const double phase = 2.0 * M_PI * ((qint64(j) * start) % fftLength) / fftLength
+                               - 0.5 * theta * (length - 1);
+            const double gain = amplitude[j - lower] / (2.0 * peak);
+            m_real.append(float(gain * std::cos(phase)));
+            m_imag.append(float(gain * std::sin(phase)));
+        }
+        m_offset[band + 1] = m_real.count();
+    }
+}
+
+void ConstantQKernel::apply(const float *output, float *real, float *imag) const
+{
+    // FFTReal stores the imaginary parts negated
+    const float *outputImag = output + m_fftLength / 2;
+    const float *kernelReal = m_real.constData();
+    const float *kernelImag = m_imag.constData();
+
+    const int bands = bandCount();
+    for (int band = 0; band < bands; ++band)
+    {
+        const int first = m_firstBin[band];
+        const int begin = m_offset[band];
+        const int count = m_offset[band + 1] - begin;
+
+        const float *xr = output + first;
+        const float *xi = outputImag + first;
+        const float *kr = kernelReal + begin;
+        const float *ki = kernelImag + begin;
+
+        float re = 0.0f;
+        float im = 0.0f;
+        for (int i = 0; i < count; ++i)
+        {
+            re += xr[i] * kr[i] + xi[i] * ki[i];
+            im += xr[i] * ki[i] - xi[i] * kr[i];
+        }
+        real[band] = re;
+        imag[band] = im;
+    }
+}
+
+QSharedPointer<const ConstantQKernel> ConstantQKernel::get(int fftLength, int sampleRate, int bands,
+                                                           float lowFreq, float highFreq)
+{
+    static QMutex mutex;
+    static QHash<QByteArray, QSharedPointer<const ConstantQKernel>> kernels;
+
+    struct Key {
+        qint32  fftLength;
+        qint32  sampleRate;
+        qint32  bands;
+        float   lowFreq;
+        float   highFreq;
+    } key = { fftLength, sampleRate, bands, lowFreq, highFreq };
+    const QByteArray keyBytes(reinterpret_cast<const char*>(&key), sizeof(key));
+
+    QMutexLocker locker(&mutex);
+    QSharedPointer<const ConstantQKernel> &kernel = kernels[keyBytes];
+    if (!kernel)
+    {
+        kernel.reset(new ConstantQKernel(fftLength, sampleRate, bands, lowFreq, highFreq));
+    }
+    return kernel;
+}
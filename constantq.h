@@ -0,0 +1,79 @@
+#ifndef CONSTANTQ_H
+#define CONSTANTQ_H
+
+#include <QList>
+#include <QSharedPointer>
+
+/*!
+ * \brief Sparse spectral kernel of a constant-Q transform
+ *
+ * Brown & Puckette's method: each band is a Hann-windowed complex exponential of
+ * Q periods of its centre frequency, centred in the frame. Its spectrum is
+ * concentrated around the centre, so the transform of a frame is a sparse
+ * matrix-vector product with the FFT of the unwindowed frame. Only the bins of
+ * each band above -45 dB of its peak are kept, as one contiguous range per band.
+ *
+ * The band centres are spaced logarithmically between the limits, the centre of
+ * band k at low * (high / low)^((k + 0.5) / bands), so that bars of a logarithmic
+ * axis between the same limits get exactly one band each. Bands whose window
+ * would be longer than the FFT are limited to the FFT length, so below about
+ * Q * sampleRate / fftLength Hz the resolution is the one of the FFT.
+ *
+ * Kernels are built once per configuration, cached for the lifetime of the
+ * application and shared read-only between all calculators.
+ */
+class ConstantQKernel
+{
+public:
+    /*!
+     * \brief Shared kernel of a configuration
+     *
+     * Builds the kernel on the first request; later requests only look it up.
+     * \param[in] fftLength - N, a power of two
+     * \param[in] sampleRate - sample rate in Hz
+     * \param[in] bands - number of bands
+     * \param[in] lowFreq - left edge of the first band in Hz
+     * \param[in] highFreq - right edge of the last band in Hz
+     */
+    static QSharedPointer<const ConstantQKernel> get(int fftLength, int sampleRate, int bands,
+                                                     float lowFreq, float highFreq);
+
+    int fftLength() const { return m_fftLength; }
+    int sampleRate() const { return m_sampleRate; }
+    int bandCount() const { return m_frequencies.count(); }
+
+    /*!
+     * \brief Centre frequencies of the bands in Hz, shared between spectra
+     */
+    const QList<float> &frequencies() const { return m_frequencies; }
+
+    /*!
+     * \brief Number of stored kernel coefficients
+     */
+    int coefficientCount() const { return m_real.count(); }
+
+    /*!
+     * \brief Constant-Q transform of a frame
+     *
+     * A full scale sine at the centre of a band gives a magnitude of N / 4 in it, like
+     * the Hann windowed FFT, so the same amplitude scale applies.
+     * \param[in] output - FFTReal output of the unwindowed frame
+     * \param[out] real - bandCount() real parts
+     * \param[out] imag - bandCount() imaginary parts
+     */
+    void apply(const float *output, float *real, float *imag) const;
+
+private:
+    ConstantQKernel(int fftLength, int sampleRate, int bands, float lowFreq, float highFreq);
+
+    int                 m_fftLength;
+    int                 m_sampleRate;
+
+    QList<float>        m_frequencies;
+    QList<int>          m_firstBin;     // first FFT bin of each band
+    QList<int>          m_offset;       // first coefficient of each band, bandCount() + 1 entries
+    QList<float>        m_real;
+    QList<float>        m_imag;
+};
+
+#endif // CONSTANTQ_H
@@ -1,12 +1,15 @@
 #include "engine.h"
+#include "analysisoptions.h"
+#include "audiocapture.h"
+#include "fileplayback.h"
+#include "signalgenerator.h"
 #include "utils.h"
 #include "3rdparty/fftreal/fftreal_wrapper.h" // For FFTLengthPowerOfTwo
 
 #include <math.h>
 
-#include <QAudioSource>
-#include <QAudioSink>
 #include <QCoreApplication>
+#include <QDebug>
 #include <QFile>
 #include <QMetaObject>
 #include <QSet>
@@ -16,7 +19,12 @@
 // Constants
 //-----------------------------------------------------------------------------
 
-const qint64 BufferDurationUs = 10 * 100000000;
+// Amount of audio held by the capture ring buffer
+const qint64 RingBufferDurationUs = 5 * 1000000;
+
+// Range of the bands selected with --constant-q, the one of the GUI
+const qreal ConstantQLowFreq = 20.0;
+const qreal ConstantQHighFreq = 20000.0;
 
 int frames = 120;
 int fps = 1000 / frames;
@@ -32,25 +40,85 @@ Engine::Engine(QObject *parent)
     ,   m_devices(new QMediaDevices(this))
     ,   m_availableAudioInputDevices(m_devices->audioInputs())
     ,   m_audioInputDevice(m_devices->defaultAudioInput())
-    ,   m_audioInput(nullptr)
-    ,   m_audioInputIODevice(nullptr)
-    ,   m_recordPosition(0)
-    ,   m_bufferPosition(0)
-    ,   m_bufferLength(0)
-    ,   m_dataLength(0)
+    ,   m_captureThread(new QThread(this))
+    ,   m_provider(nullptr)
+    ,   m_captureReady(false)
+    ,   m_fftLengthPowerOfTwo(FFTLengthPowerOfTwo)
     ,   m_spectrumBufferLength(0)
     ,   m_spectrumPosition(0)
+    ,   m_analysisMode(TimerDriven)
+    ,   m_hopSize(PowerOfTwo<FFTLengthPowerOfTwo>::Result / 2)
+    ,   m_requestedHopSize(0)
+    ,   m_nextFramePosition(0)
+    ,   m_overwrittenFrames(0)
 {
-    connect(&m_spectrumAnalyser, QOverload<const FrequencySpectrum&>::of(&SpectrumAnalyser::spectrumChanged),
-            this, QOverload<const FrequencySpectrum&>::of(&Engine::spectrum_change));
+    connect(&m_spectrumAnalyser, &SpectrumAnalyser::droppedFramesChanged, this, [this]() {
+        emit droppedFramesChanged(droppedFrames());
+    });
+
+    // Capture runs in its own thread, so that slow painting cannot delay draining the device
+    m_captureThread->start(QThread::TimeCriticalPriority);
+
+    AnalysisOptions options;
+    if (!options.parse(QCoreApplication::instance()->arguments()))
+    {
+        qWarning() << options.errorString;
+    }
+
+    m_spectrumAnalyser.setStereoPacking(options.stereoPacking);
+    m_spectrumAnalyser.setAmplitudeScale(options.scale);
+    m_spectrumAnalyser.setWindowFunction(options.window);
+    if (options.instantaneousFrequency)
+    {
+        setInstantaneousFrequency(true);
+    }
+    if (options.constantQBands > 0)
+    {
+        setConstantQ(options.constantQBands, ConstantQLowFreq, ConstantQHighFreq);
+    }
+    if (options.analysisThreads > 0)
+    {
+        m_spectrumAnalyser.setWorkerCount(options.analysisThreads);
+    }
 
-    QStringList arguments = QCoreApplication::instance()->arguments();
-    for (int i = 0; i < arguments.count(); ++i)
+    // The length first, so that the hop is bounded to the final window, whatever the option order
+    if (options.fftLengthPowerOfTwo > 0)
+    {
+        setFFTLength(options.fftLengthPowerOfTwo);
+    }
+    if (options.hopSize > 0)
     {
-        if (arguments.at(i) == QStringLiteral("--"))
+        setHopSize(options.hopSize);
+        setAnalysisMode(SampleClocked);
+    }
+
+    PacedAudioProvider *provider = nullptr;
+    if (options.useGenerator)
+    {
+        provider = new SignalGenerator(options.generator);
+    }
+    else if (!options.playFile.isEmpty())
+    {
+        FilePlayback *playback = new FilePlayback;
+        if (playback->open(options.playFile))
         {
-            break;
+            provider = playback;
         }
+        else
+        {
+            qWarning() << "Cannot play" << options.playFile << playback->errorString();
+            delete playback;
+        }
+    }
+
+    if (provider)
+    {
+        provider->setSpeed(options.speed);
+        attachProvider(provider);
+    }
+    else
+    {
+        attachProvider(new AudioCapture);
     }
 
     initialize();
@@ -63,7 +131,11 @@ Engine::Engine(QObject *parent)
             this, &Engine::audioInputDevicesChanged);
 }
 
-Engine::~Engine() = default;
+Engine::~Engine()
+{
+    m_captureThread->quit();
+    m_captureThread->wait();
+}
 
 //-----------------------------------------------------------------------------
 // Public slots
@@ -72,24 +144,31 @@ Engine::~Engine() = default;
 
 void Engine::startRecording()
 {
-    if (m_audioInput)
+    if (m_captureReady)
     {
         if (QAudioDevice::Input == m_mode && QAudio::SuspendedState == m_state)
         {
-            m_audioInput->resume();
+            QMetaObject::invokeMethod(m_provider, &AudioProvider::resume, Qt::BlockingQueuedConnection);
         }
         else
         {
             m_spectrumAnalyser.cancelCalculation();
             emit spectrumChanged(FrequencySpectrum());
 
-            m_buffer.fill(0);
+            m_nextFramePosition = 0;
             m_mode = QAudioDevice::Input;
 
-            m_dataLength = 0;
-            m_audioInputIODevice = m_audioInput->start();
-            connect(m_audioInputIODevice, &QIODevice::readyRead,
-                    this, &Engine::audioDataReady);
+            // Clears the ring buffer in the capture thread before the provider starts
+            AudioProvider *provider = m_provider;
+            const QAudioDevice device = m_audioInputDevice;
+            const QAudioFormat format = m_format;
+            QMetaObject::invokeMethod(m_provider, [provider, device, format]() {
+                if (AudioCapture *capture = qobject_cast<AudioCapture*>(provider))
+                {
+                    capture->setDevice(device);
+                }
+                provider->start(format);
+            }, Qt::BlockingQueuedConnection);
         }
         m_notifyTimer->start();
     }
@@ -102,7 +181,7 @@ void Engine::suspend()
         switch (m_mode)
         {
         case QAudioDevice::Input:
-            m_audioInput->suspend();
+            QMetaObject::invokeMethod(m_provider, &AudioProvider::suspend, Qt::BlockingQueuedConnection);
             break;
         default:
             break;
@@ -112,6 +191,14 @@ void Engine::suspend()
     stopRecording();
 }
 
+void Engine::setAudioProvider(AudioProvider *provider)
+{
+    stopRecording();
+    reset();
+    attachProvider(provider ? provider : new AudioCapture);
+    initialize();
+}
+
 void Engine::setAudioInputDevice(const QAudioDevice &device)
 {
     if (device.id() != m_audioInputDevice.id())
@@ -131,6 +218,62 @@ void Engine::FPSchanged(const int i)
     m_notifyTimer->setInterval(fps);
 }
 
+void Engine::setAnalysisMode(AnalysisMode mode)
+{
+    if (mode != m_analysisMode)
+    {
+        m_analysisMode = mode;
+
+        // Continue from the newest complete window
+        m_nextFramePosition = 0;
+        const qint64 dataLength = m_ringBuffer.writePosition();
+        if (m_spectrumBufferLength > 0 && dataLength >= m_spectrumBufferLength)
+        {
+            m_nextFramePosition = dataLength - m_spectrumBufferLength;
+            m_nextFramePosition -= m_nextFramePosition % m_format.bytesPerFrame();
+        }
+    }
+}
+
+void Engine::setHopSize(int samples)
+{
+    m_requestedHopSize = samples;
+    m_hopSize = qBound(1, samples, 1 << m_fftLengthPowerOfTwo);
+}
+
+void Engine::setFFTLength(int powerOfTwo)
+{
+    powerOfTwo = qBound(FFTLengthPowerOfTwoMin, powerOfTwo, FFTLengthPowerOfTwoMax);
+    if (powerOfTwo != m_fftLengthPowerOfTwo)
+    {
+        // Keep the same overlap with the new window, unless the hop was chosen explicitly
+        const qint64 hopSize = m_requestedHopSize > 0
+                ? m_requestedHopSize
+                : (qint64(m_hopSize) << powerOfTwo) >> m_fftLengthPowerOfTwo;
+
+        m_fftLengthPowerOfTwo = powerOfTwo;
+        m_spectrumAnalyser.setFFTLength(m_fftLengthPowerOfTwo);
+        setFormat(m_format);
+        m_hopSize = qBound(1, int(hopSize), 1 << m_fftLengthPowerOfTwo);
+    }
+}
+
+void Engine::setInstantaneousFrequency(bool enabled)
+{
+    m_spectrumAnalyser.setInstantaneousFrequency(enabled);
+    setFormat(m_format);
+}
+
+void Engine::setWindowFunction(const WindowFunction &function)
+{
+    m_spectrumAnalyser.setWindowFunction(function);
+}
+
+void Engine::setConstantQ(int bands, qreal lowFreq, qreal highFreq)
+{
+    m_spectrumAnalyser.setConstantQ(bands, float(lowFreq), float(highFreq));
+}
+
 //-----------------------------------------------------------------------------
 // Private slots
 //-----------------------------------------------------------------------------
@@ -140,13 +283,29 @@ void Engine::audioNotify()
     switch (m_mode)
     {
         case QAudioDevice::Input:
-            if (m_dataLength >= m_spectrumBufferLength)
+        {
+            // Show the newest spectrum published by the analyser; the reference stays
+            // valid until the next tick, so the receivers read it in place
+            if (m_spectrumAnalyser.updateSpectrum())
             {
-                const qint64 spectrumPosition = m_dataLength - m_spectrumBufferLength;
+                emit spectrumChanged(m_spectrumAnalyser.spectrum());
+            }
+
+            // In SampleClocked mode frames are analysed as samples arrive
+            if (SampleClocked == m_analysisMode)
+            {
+                break;
+            }
+
+            const qint64 dataLength = m_ringBuffer.writePosition();
+            if (m_spectrumBufferLength > 0 && dataLength >= m_spectrumBufferLength)
+            {
+                qint64 spectrumPosition = dataLength - m_spectrumBufferLength;
+                spectrumPosition -= spectrumPosition % m_format.bytesPerFrame();
                 calculateSpectrum(spectrumPosition);
             }
-            emit bufferChanged(m_dataLength, m_buffer);
             break;
+        }
         default:
             break;
     }
@@ -154,29 +313,18 @@ void Engine::audioNotify()
 
 void Engine::audioDataReady()
 {
-    Q_ASSERT(0 == m_bufferPosition);
-    const qint64 bytesReady = m_audioInput->bytesAvailable();
-    const qint64 bytesSpace = m_buffer.size() - m_dataLength;
-    const qint64 bytesToRead = qMin(bytesReady, bytesSpace);
+    // Any data written after this point triggers a new notification
+    m_provider->acknowledge();
 
-    const qint64 bytesRead = m_audioInputIODevice->read(
-                                       m_buffer.data() + m_dataLength,
-                                       bytesToRead);
-
-    if (bytesRead)
+    if (SampleClocked == m_analysisMode)
     {
-        m_dataLength += bytesRead;
-    }
-
-    if (m_buffer.size() == m_dataLength)
-    {
-        stopRecording();
+        scheduleFrames();
     }
 }
 
-void Engine::spectrum_change(const FrequencySpectrum &spectrum)
+void Engine::audioStateChanged(QAudio::State state)
 {
-    emit spectrumChanged(spectrum);
+    m_state = state;
 }
 
 void Engine::audioInputDevicesChanged()
@@ -198,9 +346,9 @@ QAudioDevice Engine::audioInputDeviceSelected()
 
 void Engine::resetAudioDevices()
 {
-    delete m_audioInput;
-    m_audioInput = nullptr;
-    m_audioInputIODevice = nullptr;
+    QMetaObject::invokeMethod(m_provider, &AudioProvider::stop, Qt::BlockingQueuedConnection);
+    m_captureReady = false;
+    m_state = QAudio::StoppedState;
     m_spectrumPosition = 0;
 }
 
@@ -208,10 +356,7 @@ void Engine::reset()
 {
     stopRecording();
     setFormat(QAudioFormat());
-    m_buffer.clear();
-    m_bufferPosition = 0;
-    m_bufferLength = 0;
-    m_dataLength = 0;
+    m_ringBuffer.resize(0);
     resetAudioDevices();
 }
 
@@ -226,11 +371,8 @@ bool Engine::initialize()
         if (m_format != format)
         {
             resetAudioDevices();
-            m_bufferLength = m_format.bytesForDuration(BufferDurationUs);
-            m_buffer.resize(m_bufferLength);
-            m_buffer.fill(0);
-            emit bufferChanged(0, m_buffer);
-            m_audioInput = new QAudioSource(m_audioInputDevice, m_format, this);
+            m_ringBuffer.resize(m_format.bytesForDuration(RingBufferDurationUs));
+            m_captureReady = true;
             result = true;
         }
     }
@@ -238,8 +380,31 @@ bool Engine::initialize()
     return result;
 }
 
+void Engine::attachProvider(AudioProvider *provider)
+{
+    if (m_provider)
+    {
+        QMetaObject::invokeMethod(m_provider, &AudioProvider::stop, Qt::BlockingQueuedConnection);
+        m_provider->deleteLater();
+    }
+
+    m_provider = provider;
+    m_provider->setRingBuffer(&m_ringBuffer);
+    m_provider->moveToThread(m_captureThread);
+    connect(m_captureThread, &QThread::finished, m_provider, &QObject::deleteLater);
+    connect(m_provider, &AudioProvider::dataAvailable, this, &Engine::audioDataReady);
+    connect(m_provider, &AudioProvider::stateChanged, this, &Engine::audioStateChanged);
+}
+
 bool Engine::selectFormat()
 {
+    const QAudioFormat providerFormat = m_provider->format();
+    if (providerFormat.isValid())
+    {
+        setFormat(providerFormat);
+        return true;
+    }
+
     bool foundSupportedFormat = false;
 
     int minSampleRate = m_audioInputDevice.minimumSampleRate();
@@ -248,14 +413,36 @@ bool Engine::selectFormat()
     int maxChannelCount = m_audioInputDevice.maximumChannelCount();
 
     QAudioFormat format;
-    format.setSampleFormat(QAudioFormat::Int16);
     format.setSampleRate(qBound(minSampleRate, 48000, maxSampleRate));
     format.setChannelCount(qBound(minChannelCount, 2, maxChannelCount));
 
-    const bool inputSupport = m_audioInputDevice.isFormatSupported(format);
-    if (inputSupport)
+    // Native format first, then by dynamic range
+    const QAudioFormat::SampleFormat candidates[] = {
+        m_audioInputDevice.preferredFormat().sampleFormat(),
+        QAudioFormat::Float,
+        QAudioFormat::Int32,
+        QAudioFormat::Int16,
+        QAudioFormat::UInt8
+    };
+
+    for (const QAudioFormat::SampleFormat sampleFormat : candidates)
+    {
+        if (QAudioFormat::Unknown == sampleFormat)
+        {
+            continue;
+        }
+
+        format.setSampleFormat(sampleFormat);
+        if (m_audioInputDevice.isFormatSupported(format))
+        {
+            foundSupportedFormat = true;
+            break;
+        }
+    }
+
+    if (!foundSupportedFormat)
     {
-        foundSupportedFormat = true;
+        format.setSampleFormat(QAudioFormat::Int16);
     }
 
     setFormat(format);
@@ -265,32 +452,61 @@ bool Engine::selectFormat()
 
 void Engine::stopRecording()
 {
-    if (m_audioInput)
-    {
-        m_audioInput->stop();
-        QCoreApplication::instance()->processEvents();
-        m_audioInput->disconnect();
-    }
-    m_audioInputIODevice = nullptr;
+    QMetaObject::invokeMethod(m_provider, &AudioProvider::stop, Qt::BlockingQueuedConnection);
+    m_state = QAudio::StoppedState;
     m_notifyTimer->stop();
 }
 
 void Engine::calculateSpectrum(qint64 position)
 {
-    Q_ASSERT(position + m_spectrumBufferLength <= m_bufferPosition + m_dataLength);
+    Q_ASSERT(position + m_spectrumBufferLength <= m_ringBuffer.writePosition());
     Q_ASSERT(0 == m_spectrumBufferLength % 2); // constraint of FFT algorithm
 
-    if (m_spectrumAnalyser.isReady())
+    // The analyser queues the frame, or drops its oldest queued one and counts it
+    m_spectrumBuffer.resize(m_spectrumBufferLength);
+    if (m_ringBuffer.read(position, m_spectrumBuffer.data(), m_spectrumBufferLength))
     {
-        m_spectrumBuffer = QByteArray::fromRawData(m_buffer.constData() + position - m_bufferPosition,
-                                                   m_spectrumBufferLength);
         m_spectrumPosition = position;
         m_spectrumAnalyser.calculate(m_spectrumBuffer, m_format);
+        emit bufferChanged(m_spectrumPosition, m_spectrumBuffer);
+    }
+    else
+    {
+        // The writer overtook the window during the copy, the frame is lost like a skipped hop
+        ++m_overwrittenFrames;
+        emit droppedFramesChanged(droppedFrames());
+    }
+}
+
+void Engine::scheduleFrames()
+{
+    if (0 == m_spectrumBufferLength)
+    {
+        return;
+    }
+
+    const qint64 dataLength = m_ringBuffer.writePosition();
+    const qint64 hopLength = qint64(m_hopSize) * m_format.bytesPerFrame();
+
+    // Windows that already left the ring are lost, skip whole hops past them
+    const qint64 oldestPosition = dataLength - m_ringBuffer.capacity();
+    if (m_nextFramePosition < oldestPosition)
+    {
+        const qint64 hops = (oldestPosition - m_nextFramePosition + hopLength - 1) / hopLength;
+        m_nextFramePosition += hops * hopLength;
+        m_overwrittenFrames += hops;
+        emit droppedFramesChanged(droppedFrames());
+    }
+
+    while (m_nextFramePosition + m_spectrumBufferLength <= dataLength)
+    {
+        calculateSpectrum(m_nextFramePosition);
+        m_nextFramePosition += hopLength;
     }
 }
 
 void Engine::setFormat(const QAudioFormat &format)
 {
     m_format = format;
-    m_spectrumBufferLength = PowerOfTwo<FFTLengthPowerOfTwo>::Result * format.bytesPerFrame();
+    m_spectrumBufferLength = m_spectrumAnalyser.frameLength() * format.bytesPerFrame();
 }
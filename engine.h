@@ -2,7 +2,9 @@
 #define ENGINE_H
 
 #include "spectrumanalyser.h"
+#include "ringbuffer.h"
 
+#include <QAudio>
 #include <QAudioDevice>
 #include <QAudioFormat>
 #include <QBuffer>
@@ -13,17 +15,19 @@
 #include <QMediaDevices>
 #include <QTimer>
 
+class AudioProvider;
 class FrequencySpectrum;
 QT_BEGIN_NAMESPACE
-class QAudioSource;
-class QAudioSink;
+class QThread;
 QT_END_NAMESPACE
 
 /*!
  * \brief Engine Class
  *
  * Class is responsible for interaction with audio devices, sampling their audio and
- * computing FFT in real time.
+ * computing FFT in real time. Audio comes from an AudioProvider running in a separate
+ * high priority thread, which hands the data over through the ring buffer. By default
+ * the provider is AudioCapture, which drains the selected input device.
  */
 class Engine : public QObject
 {
@@ -33,6 +37,17 @@ public:
     explicit Engine(QObject *parent = 0);
     ~Engine();
 
+    /*!
+     * \brief Analysis scheduling mode
+     *
+     * TimerDriven - the newest window is analysed on every tick of the display timer
+     * SampleClocked - a window is analysed every hop size of captured samples, the display timer only shows the newest result
+     */
+    enum AnalysisMode {
+        TimerDriven,
+        SampleClocked
+    };
+
     /*!
      * \brief List of available input devices
      *
@@ -51,9 +66,51 @@ public:
     /*!
      * \brief Returns length of the data
      *
-     * \param[out] m_dataLength - length of the data
+     * Total amount of bytes captured since recording started. Only the newest
+     * part of it is held by the ring buffer.
+     * \param[out] qint64 - length of the data
+     */
+    qint64 dataLength() const { return m_ringBuffer.writePosition(); }
+
+    /*!
+     * \brief Returns analysis scheduling mode
+     *
+     * \param[out] m_analysisMode - current mode
+     */
+    AnalysisMode analysisMode() const { return m_analysisMode; }
+
+    /*!
+     * \brief Returns distance between starts of consecutive analysis windows
+     *
+     * \param[out] m_hopSize - hop size in samples
      */
-    qint64 dataLength() const { return m_dataLength; }
+    int hopSize() const { return m_hopSize; }
+
+    /*!
+     * \brief Returns length of the FFT
+     *
+     * \param[out] m_fftLengthPowerOfTwo - length of the FFT as a power of 2
+     */
+    int fftLengthPowerOfTwo() const { return m_fftLengthPowerOfTwo; }
+
+    /*!
+     * \brief Returns window applied before the FFT
+     */
+    WindowFunction windowFunction() const { return m_spectrumAnalyser.windowFunction(); }
+
+    /*!
+     * \brief Returns number of constant-Q bands, 0 if the spectra hold FFT bins
+     */
+    int constantQBands() const { return m_spectrumAnalyser.constantQBands(); }
+
+    /*!
+     * \brief Returns number of analysis frames lost since the engine was created
+     *
+     * Counts frames dropped by the analyser because its queue was full, and in
+     * SampleClocked mode hops overwritten in the ring buffer before they were analysed.
+     * \param[out] qint64 - number of lost frames
+     */
+    qint64 droppedFrames() const { return m_spectrumAnalyser.droppedFrames() + m_overwrittenFrames; }
 
 public slots:
 
@@ -72,6 +129,16 @@ public slots:
      */
     void suspend();
 
+    /*!
+     * \brief Replaces the source of the audio
+     *
+     * Stops recording and takes ownership of the provider, which must not have a parent,
+     * as it is moved to the capture thread. A provider with a fixed
+     * format, e.g. SignalGenerator or FilePlayback, is used instead of the input device.
+     * \param[in] provider - new provider, nullptr to capture from the input device again
+     */
+    void setAudioProvider(AudioProvider *provider);
+
     /*!
      * \brief Sets selected device as a default input device
      *
@@ -86,6 +153,62 @@ public slots:
      */
     void FPSchanged(const int i);
 
+    /*!
+     * \brief Sets analysis scheduling mode
+     *
+     * \param[in] mode - new mode
+     */
+    void setAnalysisMode(AnalysisMode mode);
+
+    /*!
+     * \brief Sets distance between starts of consecutive analysis windows
+     *
+     * Used in SampleClocked mode, e.g. half of the window length gives 50% overlap.
+     * A hop set here is kept when the FFT length changes, only bounded to the new length.
+     * \param[in] samples - hop size in samples, bounded to [1, window length]
+     */
+    void setHopSize(int samples);
+
+    /*!
+     * \brief Sets length of the FFT
+     *
+     * Small lengths give low latency, large lengths give fine frequency resolution.
+     * The default hop is scaled to keep the same overlap; one set by setHopSize() is not.
+     * \param[in] powerOfTwo - length of the FFT as a power of 2, bounded to [FFTLengthPowerOfTwoMin, FFTLengthPowerOfTwoMax]
+     */
+    void setFFTLength(int powerOfTwo);
+
+    /*!
+     * \brief Sets window applied before the FFT
+     *
+     * Takes effect from the next analysed frame, without restarting the capture.
+     * \param[in] function - window type and parameter
+     */
+    void setWindowFunction(const WindowFunction &function);
+
+    /*!
+     * \brief Enables instantaneous frequencies in the spectra
+     *
+     * Each frame is analysed together with the window N/4 samples earlier, and the phase
+     * difference gives the frequency of every bin finer than the bin spacing. The FFT work
+     * doubles, the latency does not change.
+     * \param[in] enabled - if the instantaneous frequencies are computed
+     */
+    void setInstantaneousFrequency(bool enabled);
+
+    /*!
+     * \brief Enables the constant-Q transform
+     *
+     * The spectra then hold bands with logarithmically spaced centres instead of FFT bins,
+     * each measured by its own kernel with the same resolution per octave. The kernel is
+     * applied to the FFT of the frame as a sparse product, so the FFT length still bounds
+     * the resolution of the lowest bands.
+     * \param[in] bands - number of bands, 0 for FFT bins
+     * \param[in] lowFreq - left edge of the first band in Hz
+     * \param[in] highFreq - right edge of the last band in Hz
+     */
+    void setConstantQ(int bands, qreal lowFreq, qreal highFreq);
+
     /*!
      * \brief New audio device has been selected
      */
@@ -104,6 +227,8 @@ signals:
      * \brief Signals that spectrum has changed
      *
      * Sends signal for the other classes that spectrum has changed, because of the new FFT calculation has been completed.
+     * Emitted on the display timer with the newest spectrum of the analyser. The spectrum is not copied, so it is
+     * only valid during the call; receivers that keep it copy it with FrequencySpectrum::assign.
      * \param[in] spectrum - new spectrum
      */
     void spectrumChanged(const FrequencySpectrum &spectrum);
@@ -111,16 +236,24 @@ signals:
     /*!
      * \brief Audio buffer has changed
      *
-     * \param[in] length - length of buffer
-     * \param[in] buffer - new audio buffer
+     * \param[in] position - position of the analysed window in the captured stream
+     * \param[in] buffer - newest analysed window of audio, starting with the earlier hop
+     *                     when instantaneous frequencies are enabled
      */
-    void bufferChanged(qint64 length, const QByteArray &buffer);
+    void bufferChanged(qint64 position, const QByteArray &buffer);
 
     /*!
      * \brief List of the devices has changed
      */
     void devicesChanged();
 
+    /*!
+     * \brief Analysis frames have been lost
+     *
+     * \param[in] dropped - total number of lost frames, see droppedFrames
+     */
+    void droppedFramesChanged(qint64 dropped);
+
 
 private slots:
 
@@ -130,17 +263,16 @@ private slots:
     void audioNotify();
 
     /*!
-     * \brief Method for reading audio data
+     * \brief New audio data is available in the ring buffer
      */
     void audioDataReady();
 
     /*!
-     * \brief Spectrum has changed
+     * \brief State of the audio device has changed
      *
-     * Signals that FFT calculation has been completed.
-     * \param[in] spectrum - new spectrum
+     * \param[in] state - new state
      */
-    void spectrum_change(const FrequencySpectrum &spectrum);
+    void audioStateChanged(QAudio::State state);
 
 private:
 
@@ -156,9 +288,19 @@ private:
      */
     bool initialize();
 
+    /*!
+     * \brief Moves a provider to the capture thread and connects it
+     *
+     * \param[in] provider - new provider, replaces and deletes the current one
+     */
+    void attachProvider(AudioProvider *provider);
+
     /*!
      * \brief Checks if format is available
      *
+     * Takes the format of the provider if it has a fixed one. Otherwise picks the first sample
+     * format supported by the device out of its preferred one, Float, Int32, Int16 and UInt8,
+     * so that the backend does not have to convert.
      * \return If format is available
      */
     bool selectFormat();
@@ -173,10 +315,17 @@ private:
     /*!
      * \brief Prepares data and starts FFT
      *
-     * \param[in] position - possition of buffer
+     * \param[in] position - position of the window in the captured stream
      */
     void calculateSpectrum(qint64 position);
 
+    /*!
+     * \brief Starts analysis of every complete hop captured since the last call
+     *
+     * Used in SampleClocked mode.
+     */
+    void scheduleFrames();
+
 private:
 
     QAudioDevice::Mode  m_mode;
@@ -187,22 +336,24 @@ private:
 
     QList<QAudioDevice> m_availableAudioInputDevices;
     QAudioDevice        m_audioInputDevice;
-    QAudioSource*       m_audioInput;
-    QIODevice*          m_audioInputIODevice;
-    qint64              m_recordPosition;
+    QThread*            m_captureThread;
+    AudioProvider*      m_provider;
+    bool                m_captureReady;
 
-    qint64              m_playPosition;
-
-    QByteArray          m_buffer;
-    qint64              m_bufferPosition;
-    qint64              m_bufferLength;
-    qint64              m_dataLength;
+    RingBuffer          m_ringBuffer;
 
+    int                 m_fftLengthPowerOfTwo;
     int                 m_spectrumBufferLength;
     QByteArray          m_spectrumBuffer;
     SpectrumAnalyser    m_spectrumAnalyser;
     qint64              m_spectrumPosition;
 
+    AnalysisMode        m_analysisMode;
+    int                 m_hopSize;
+    int                 m_requestedHopSize;
+    qint64              m_nextFramePosition;
+    qint64              m_overwrittenFrames;
+
     QTimer*             m_notifyTimer = nullptr;
 
 };
@@ -0,0 +1,78 @@
+#include "fftbenchmark.h"
+#include "spectrumkernels.h"
+#include "3rdparty/fftreal/fftreal_wrapper.h"
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#include <cmath>
+
+// Samples transformed per length and path, enough for stable timings
+const qint64 BenchmarkSamples = 1 << 24;
+
+bool benchmarkFFT()
+{
+    typedef FFTRealWrapper::DataType DataType;
+    QTextStream out(stdout);
+
+    double log2Error = 0.0;
+    double atan2Error = 0.0;
+    double simdDifference = 0.0;
+    const bool accurate = checkApproximations(&log2Error, &atan2Error, &simdDifference);
+    out << "fastLog2 error " << log2Error << ", fastAtan2 error " << atan2Error
+        << " rad, SSE2 difference " << simdDifference << (accurate ? "" : "  FAILED") << "\n\n";
+
+    out << "length  two transforms [us]  stereo packed [us]  max difference\n";
+
+    for (int powerOfTwo = FFTLengthPowerOfTwoMin; powerOfTwo <= FFTLengthPowerOfTwoMax; ++powerOfTwo)
+    {
+        const int length = 1 << powerOfTwo;
+        const int iterations = int(qMax(BenchmarkSamples / length, qint64(4)));
+
+        QList<DataType> left(length), right(length), interleaved(2 * length);
+        QList<DataType> outLeft(length), outRight(length), packedLeft(length), packedRight(length);
+        for (int i = 0; i < length; ++i)
+        {
+            left[i] = DataType(QRandomGenerator::global()->generateDouble() - 0.5);
+            right[i] = DataType(QRandomGenerator::global()->generateDouble() - 0.5);
+            interleaved[2 * i] = left[i];
+            interleaved[2 * i + 1] = right[i];
+        }
+
+        FFTRealWrapper fft(powerOfTwo);
+        FFTRealStereoWrapper stereoFft(powerOfTwo);
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i)
+        {
+            fft.calculateFFT(outLeft.data(), left.constData());
+            fft.calculateFFT(outRight.data(), right.constData());
+        }
+        const double twoUs = timer.nsecsElapsed() / 1000.0 / iterations;
+
+        timer.restart();
+        for (int i = 0; i < iterations; ++i)
+        {
+            stereoFft.calculateFFT(packedLeft.data(), packedRight.data(), interleaved.constData());
+        }
+        const double packedUs = timer.nsecsElapsed() / 1000.0 / iterations;
+
+        double difference = 0.0;
+        for (int i = 0; i < length; ++i)
+        {
+            difference = qMax(difference, double(std::fabs(outLeft[i] - packedLeft[i])));
+            difference = qMax(difference, double(std::fabs(outRight[i] - packedRight[i])));
+        }
+
+        out << qSetFieldWidth(6) << length << qSetFieldWidth(0) << "  "
+            << qSetFieldWidth(19) << QString::number(twoUs, 'f', 2) << qSetFieldWidth(0) << "  "
+            << qSetFieldWidth(18) << QString::number(packedUs, 'f', 2) << qSetFieldWidth(0) << "  "
+            << difference << "\n";
+        out.flush();
+    }
+
+    return accurate;
+}
@@ -0,0 +1,17 @@
+#ifndef FFTBENCHMARK_H
+#define FFTBENCHMARK_H
+
+/*!
+ * \brief Benchmarks the stereo analysis paths
+ *
+ * For every selectable FFT length, times two FFTRealWrapper::calculateFFT
+ * calls against one FFTRealStereoWrapper::calculateFFT call on the same
+ * random stereo signal, and prints the time per frame together with the
+ * largest difference between the spectra of both paths. The errors of the
+ * log2 and atan2 approximations are checked first, see checkApproximations().
+ * Run with --benchmark-fft.
+ * \return If the approximations are within their documented bounds
+ */
+bool benchmarkFFT();
+
+#endif // FFTBENCHMARK_H
@@ -0,0 +1,180 @@
+#include "fileanalyser.h"
+#include "spectrumcalculator.h"
+#include "wavfile.h"
+#include "3rdparty/fftreal/fftreal_wrapper.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThreadPool>
+#include <QtEndian>
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "spectra are written in host byte order");
+
+// Size of the output header in bytes
+const qint64 FileAnalyserHeaderSize = 40;
+
+// Spectra calculated by one pool task
+const qint64 FileAnalyserFramesPerTask = 64;
+
+FileAnalyser::FileAnalyser()
+    :   m_fftLengthPowerOfTwo(FFTLengthPowerOfTwo)
+    ,   m_hopSize(0)
+    ,   m_frameCount(0)
+{
+}
+
+void FileAnalyser::setFFTLength(int powerOfTwo)
+{
+    m_fftLengthPowerOfTwo = qBound(FFTLengthPowerOfTwoMin, powerOfTwo, FFTLengthPowerOfTwoMax);
+}
+
+void FileAnalyser::setHopSize(int hopSize)
+{
+    m_hopSize = qMax(hopSize, 0);
+}
+
+void FileAnalyser::setAmplitudeScale(const AmplitudeScale &scale)
+{
+    m_scale = scale;
+}
+
+void FileAnalyser::setWindowFunction(const WindowFunction &function)
+{
+    m_windowFunction = function;
+}
+
+void FileAnalyser::setOptions(const AnalysisOptions &options)
+{
+    if (options.fftLengthPowerOfTwo > 0)
+    {
+        setFFTLength(options.fftLengthPowerOfTwo);
+    }
+    if (options.hopSize > 0)
+    {
+        setHopSize(options.hopSize);
+    }
+    setAmplitudeScale(options.scale);
+    setWindowFunction(options.window);
+}
+
+bool FileAnalyser::analyse(const QString &inputFile, const QString &outputFile)
+{
+    m_frameCount = 0;
+
+    WavFile wav;
+    if (!wav.open(inputFile))
+    {
+        m_errorString = inputFile + QStringLiteral(": ") + wav.errorString();
+        return false;
+    }
+
+    const QAudioFormat format = wav.format();
+    const int length = 1 << m_fftLengthPowerOfTwo;
+    const int hopSize = m_hopSize > 0 ? m_hopSize : length / 2;
+    const int bytesPerFrame = format.bytesPerFrame();
+    const int channels = format.channelCount() >= 2 ? int(FrequencySpectrum::ChannelCount) : 1;
+    const int bins = length / 2 + 1;
+    const qint64 frames = wav.frameCount() >= length ? (wav.frameCount() - length) / hopSize + 1 : 0;
+    const qint64 frameBytes = qint64(channels) * bins * sizeof(float);
+
+    QFile output(outputFile);
+    if (!output.open(QIODevice::ReadWrite | QIODevice::Truncate)
+        || !output.resize(FileAnalyserHeaderSize + frames * frameBytes))
+    {
+        m_errorString = outputFile + QStringLiteral(": ") + output.errorString();
+        return false;
+    }
+
+    uchar *map = output.map(0, output.size());
+    if (!map)
+    {
+        m_errorString = outputFile + QStringLiteral(": ") + output.errorString();
+        return false;
+    }
+
+    // Header
+    memcpy(map, "ASPC", 4);
+    qToLittleEndian<quint32>(1, map + 4);
+    qToLittleEndian<quint32>(format.sampleRate(), map + 8);
+    qToLittleEndian<quint32>(length, map + 12);
+    qToLittleEndian<quint32>(hopSize, map + 16);
+    qToLittleEndian<quint32>(channels, map + 20);
+    qToLittleEndian<quint32>(bins, map + 24);
+    qToLittleEndian<quint32>(0, map + 28);
+    qToLittleEndian<quint64>(frames, map + 32);
+
+    // Fan the frames out in blocks, each block with its own calculator
+    const int powerOfTwo = m_fftLengthPowerOfTwo;
+    const AmplitudeScale scale = m_scale;
+    const WindowFunction window = m_windowFunction;
+    const char *data = wav.data();
+    QThreadPool *pool = QThreadPool::globalInstance();
+    for (qint64 first = 0; first < frames; first += FileAnalyserFramesPerTask)
+    {
+        const qint64 last = qMin(first + FileAnalyserFramesPerTask, frames);
+        pool->start([=]()
+        {
+            SpectrumCalculator calculator(powerOfTwo);
+            calculator.setWindowFunction(window);
+            calculator.setAmplitudeScale(scale);
+            for (qint64 frame = first; frame < last; ++frame)
+            {
+                const FrequencySpectrum &spectrum = calculator.calculate(
+                            data + frame * hopSize * bytesPerFrame, format.sampleRate(),
+                            bytesPerFrame, format.channelCount(), format.sampleFormat());
+
+                float *out = reinterpret_cast<float*>(map + FileAnalyserHeaderSize + frame * frameBytes);
+                for (int channel = 0; channel < channels; ++channel)
+                {
+                    memcpy(out, spectrum.amplitudes(FrequencySpectrum::Channel(channel)), bins * sizeof(float));
+                    out += bins;
+                }
+            }
+        });
+    }
+    pool->waitForDone();
+
+    output.unmap(map);
+    output.close();
+
+    m_frameCount = frames;
+    return true;
+}
+
+int analyseFileFromArguments(const QStringList &arguments)
+{
+    const int index = arguments.indexOf(QStringLiteral("--analyse-file"));
+    if (index < 0 || index + 2 >= arguments.count())
+    {
+        std::cerr << "usage: --analyse-file <input.wav> <output> [--fft-size <samples>] [--hop-size <samples>]"
+                     " [--db-scale] [--db-floor <dB>] [--db-ceiling <dB>]"
+                     " [--window <name>] [--window-parameter <value>]" << std::endl;
+        return 1;
+    }
+
+    AnalysisOptions options;
+    if (!options.parse(arguments))
+    {
+        std::cerr << qPrintable(options.errorString) << std::endl;
+        return 1;
+    }
+
+    FileAnalyser analyser;
+    analyser.setOptions(options);
+
+    const QString &outputFile = arguments.at(index + 2);
+    QElapsedTimer timer;
+    timer.start();
+    if (!analyser.analyse(arguments.at(index + 1), outputFile))
+    {
+        std::cerr << qPrintable(analyser.errorString()) << std::endl;
+        return 1;
+    }
+    std::cerr << analyser.frameCount() << " spectra written to " << qPrintable(outputFile)
+              << " in " << timer.elapsed() << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,111 @@
+#ifndef FILEANALYSER_H
+#define FILEANALYSER_H
+
+#include <QString>
+#include <QStringList>
+
+#include "analysisoptions.h"
+#include "spectrumkernels.h"
+#include "windowfunction.h"
+
+/*!
+ * \brief FileAnalyser Class
+ *
+ * Analyses a WAV file offline, much faster than real time. The input is memory-mapped
+ * and the frames are transformed straight from the mapping by SpectrumCalculator, the same
+ * code as the live view. Frames are spread over all cores with QThreadPool, each task
+ * owning its calculator, and every task writes its spectra into its own slice of the
+ * memory-mapped output, so the workers never wait for each other.
+ *
+ * Output file layout, little-endian:
+ *   char[4]  magic "ASPC"
+ *   quint32  version (1)
+ *   quint32  sample rate in Hz
+ *   quint32  FFT length in samples
+ *   quint32  hop size in samples
+ *   quint32  channels per frame (1 for mono, Left/Right/Mid/Side for stereo)
+ *   quint32  bins per channel (FFT length / 2 + 1)
+ *   quint32  reserved, 0
+ *   quint64  number of frames
+ *   float    amplitudes in range [0.0, 1.0], [frame][channel][bin]
+ */
+class FileAnalyser
+{
+public:
+    FileAnalyser();
+
+    /*!
+     * \brief Sets the FFT length
+     *
+     * \param[in] powerOfTwo - power of two of the length
+     */
+    void setFFTLength(int powerOfTwo);
+
+    /*!
+     * \brief Sets the distance between consecutive frames
+     *
+     * \param[in] hopSize - hop in samples, 0 for half the FFT length
+     */
+    void setHopSize(int hopSize);
+
+    /*!
+     * \brief Sets the mapping of the bin power to the stored amplitudes
+     *
+     * \param[in] scale - logarithmic or decibel scale
+     */
+    void setAmplitudeScale(const AmplitudeScale &scale);
+
+    /*!
+     * \brief Sets the window applied before the FFT
+     *
+     * \param[in] function - window type and parameter
+     */
+    void setWindowFunction(const WindowFunction &function);
+
+    /*!
+     * \brief Applies the FFT length, hop size, amplitude scale and window of the options
+     *
+     * Options which have not been given keep their current values.
+     * \param[in] options - options read from the command line
+     */
+    void setOptions(const AnalysisOptions &options);
+
+    /*!
+     * \brief Analyses a file
+     *
+     * \param[in] inputFile - WAV file to analyse
+     * \param[in] outputFile - file the spectra are written to
+     * \return If the analysis has been completed successfully
+     */
+    bool analyse(const QString &inputFile, const QString &outputFile);
+
+    /*!
+     * \brief Reason of the last failure
+     */
+    QString errorString() const { return m_errorString; }
+
+    /*!
+     * \brief Number of frames written by the last analysis
+     */
+    qint64 frameCount() const { return m_frameCount; }
+
+private:
+    int         m_fftLengthPowerOfTwo;
+    int         m_hopSize;
+    AmplitudeScale  m_scale;
+    WindowFunction  m_windowFunction;
+    qint64      m_frameCount;
+    QString     m_errorString;
+};
+
+/*!
+ * \brief Runs --analyse-file <input.wav> <output> of the command line
+ *
+ * The analysis is set up from AnalysisOptions. The usage, a failure or the
+ * throughput is printed to stderr.
+ * \param[in] arguments - command line
+ * \return Exit code of the application
+ */
+int analyseFileFromArguments(const QStringList &arguments);
+
+#endif // FILEANALYSER_H
@@ -0,0 +1,66 @@
+#include "fileplayback.h"
+
+#include <string.h>
+
+FilePlayback::FilePlayback(QObject *parent)
+    :   PacedAudioProvider(parent)
+    ,   m_frame(0)
+{
+}
+
+FilePlayback::~FilePlayback() = default;
+
+bool FilePlayback::open(const QString &fileName)
+{
+    m_frame = 0;
+    if (!m_file.open(fileName))
+    {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+
+    // An empty file would never produce a frame, and frames of another format would not fit the ring
+    if (m_file.frameCount() <= 0 || !m_file.format().isValid())
+    {
+        m_errorString = m_file.frameCount() <= 0 ? QStringLiteral("no audio frames")
+                                                 : QStringLiteral("invalid audio format");
+        m_file.close();
+        return false;
+    }
+
+    m_errorString.clear();
+    return true;
+}
+
+QAudioFormat FilePlayback::format() const
+{
+    return m_file.frameCount() > 0 ? m_file.format() : QAudioFormat();
+}
+
+void FilePlayback::rewind()
+{
+    m_frame = 0;
+}
+
+void FilePlayback::render(char *data, qint64 frameCount)
+{
+    if (m_file.frameCount() <= 0)
+    {
+        return;
+    }
+
+    const int bytesPerFrame = m_file.format().bytesPerFrame();
+    while (frameCount > 0)
+    {
+        const qint64 frames = qMin(frameCount, m_file.frameCount() - m_frame);
+        memcpy(data, m_file.data() + m_frame * bytesPerFrame, size_t(frames * bytesPerFrame));
+        data += frames * bytesPerFrame;
+        frameCount -= frames;
+
+        m_frame += frames;
+        if (m_frame == m_file.frameCount())
+        {
+            m_frame = 0;
+        }
+    }
+}
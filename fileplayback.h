@@ -0,0 +1,50 @@
+#ifndef FILEPLAYBACK_H
+#define FILEPLAYBACK_H
+
+#include "audioprovider.h"
+#include "wavfile.h"
+
+/*!
+ * \brief FilePlayback Class
+ *
+ * Plays a WAV file into the ring buffer in its own sample format, looping at the
+ * end of the file. The file stays memory-mapped, frames are copied straight from
+ * the mapping.
+ */
+class FilePlayback : public PacedAudioProvider
+{
+    Q_OBJECT
+
+public:
+    explicit FilePlayback(QObject *parent = nullptr);
+    ~FilePlayback();
+
+    /*!
+     * \brief Opens the played file
+     *
+     * Must not be called while the playback is started.
+     * \param[in] fileName - path of the WAV file
+     * \return If the file is a supported WAV file with at least one frame
+     */
+    bool open(const QString &fileName);
+
+    /*!
+     * \brief Reason of the last failure of open
+     */
+    QString errorString() const { return m_errorString; }
+
+    QAudioFormat format() const override;
+
+protected:
+
+    void rewind() override;
+    void render(char *data, qint64 frameCount) override;
+
+private:
+
+    WavFile             m_file;
+    qint64              m_frame;
+    QString             m_errorString;
+};
+
+#endif // FILEPLAYBACK_H
@@ -1,43 +1,197 @@
 #include "frequencyspectrum.h"
 
-FrequencySpectrum::FrequencySpectrum(int numPoints)
-    :   m_elements(numPoints)
+#include <QHash>
+#include <QMutex>
+
+#include <algorithm>
+
+/*!
+ * \brief Shared frequency axis of a size and sample rate
+ *
+ * Axes are built once and kept for the lifetime of the application; the
+ * returned list shares the cached data.
+ */
+static QList<float> frequencyAxis(int numBins, int sampleRate)
+{
+    static QMutex mutex;
+    static QHash<quint64, QList<float>> axes;
+
+    const quint64 key = (quint64(quint32(numBins)) << 32) | quint32(sampleRate);
+    QMutexLocker locker(&mutex);
+    QList<float> &axis = axes[key];
+    if (axis.isEmpty() && numBins > 0)
+    {
+        // Bins 0..N/2 of an N-point FFT
+        const qreal fftLength = qMax(1, 2 * (numBins - 1));
+        axis.resize(numBins);
+        for (int i = 0; i < numBins; ++i)
+        {
+            axis[i] = float(qreal(i) * sampleRate / fftLength);
+        }
+    }
+    return axis;
+}
+
+FrequencySpectrum::FrequencySpectrum(int numBins, int numChannels)
+    :   m_numBins(qMax(numBins, 0))
+    ,   m_numChannels(qMax(numChannels, 1))
+    ,   m_sampleRate(0)
+    ,   m_constantQ(false)
+    ,   m_frequencies(m_numBins, 0.0f)
+    ,   m_amplitudes(m_numBins * m_numChannels, 0.0f)
+    ,   m_phases(m_numBins * m_numChannels, 0.0f)
+    ,   m_clipMask(clipMaskWords() * m_numChannels, 0u)
 {
 }
 
 void FrequencySpectrum::reset()
 {
-    iterator i = begin();
-    for ( ; i != end(); ++i)
-        *i = Element();
+    m_amplitudes.fill(0.0f);
+    m_phases.fill(0.0f);
+    m_instantaneousFrequencies.fill(0.0f);
+    m_clipMask.fill(0u);
+}
+
+int FrequencySpectrum::channelCount() const
+{
+    return m_numChannels;
+}
+
+int FrequencySpectrum::size() const
+{
+    return m_numBins;
+}
+
+void FrequencySpectrum::setSampleRate(int sampleRate)
+{
+    if (sampleRate != m_sampleRate || m_constantQ)
+    {
+        m_sampleRate = sampleRate;
+        m_constantQ = false;
+        m_frequencies = frequencyAxis(m_numBins, sampleRate);
+    }
+}
+
+void FrequencySpectrum::setConstantQAxis(const QList<float> &frequencies, int sampleRate)
+{
+    Q_ASSERT(frequencies.count() == m_numBins);
+    m_sampleRate = sampleRate;
+    m_constantQ = true;
+    m_frequencies = frequencies;
+}
+
+const float *FrequencySpectrum::frequencies() const
+{
+    return m_frequencies.constData();
 }
 
-FrequencySpectrum::Element &FrequencySpectrum::operator[](int index)
+float *FrequencySpectrum::amplitudes(Channel channel)
 {
-    return m_elements[index];
+    return m_amplitudes.data() + channel * m_numBins;
 }
 
-const FrequencySpectrum::Element &FrequencySpectrum::operator[](int index) const
+const float *FrequencySpectrum::amplitudes(Channel channel) const
 {
-    return m_elements[index];
+    return m_amplitudes.constData() + channel * m_numBins;
 }
 
-FrequencySpectrum::iterator FrequencySpectrum::begin()
+float *FrequencySpectrum::phases(Channel channel)
 {
-    return m_elements.begin();
+    return m_phases.data() + channel * m_numBins;
 }
 
-FrequencySpectrum::iterator FrequencySpectrum::end()
+const float *FrequencySpectrum::phases(Channel channel) const
 {
-    return m_elements.end();
+    return m_phases.constData() + channel * m_numBins;
 }
 
-FrequencySpectrum::const_iterator FrequencySpectrum::begin() const
+void FrequencySpectrum::setInstantaneousFrequenciesEnabled(bool enabled)
 {
-    return m_elements.begin();
+    if (enabled != hasInstantaneousFrequencies())
+    {
+        m_instantaneousFrequencies.fill(0.0f, enabled ? m_numBins * m_numChannels : 0);
+    }
 }
 
-FrequencySpectrum::const_iterator FrequencySpectrum::end() const
+float *FrequencySpectrum::instantaneousFrequencies(Channel channel)
 {
-    return m_elements.end();
+    return hasInstantaneousFrequencies() ? m_instantaneousFrequencies.data() + channel * m_numBins : nullptr;
+}
+
+const float *FrequencySpectrum::instantaneousFrequencies(Channel channel) const
+{
+    return hasInstantaneousFrequencies() ? m_instantaneousFrequencies.constData() + channel * m_numBins : nullptr;
+}
+
+quint32 *FrequencySpectrum::clipMask(Channel channel)
+{
+    return m_clipMask.data() + channel * clipMaskWords();
+}
+
+const quint32 *FrequencySpectrum::clipMask(Channel channel) const
+{
+    return m_clipMask.constData() + channel * clipMaskWords();
+}
+
+bool FrequencySpectrum::isClipped(Channel channel, int bin) const
+{
+    return clipMask(channel)[bin / 32] & (1u << (bin % 32));
+}
+
+FrequencySpectrum FrequencySpectrum::channel(Channel channel) const
+{
+    FrequencySpectrum result;
+    result.assign(*this, channel);
+    return result;
+}
+
+void FrequencySpectrum::assign(const FrequencySpectrum &other, Channel channel)
+{
+    if (channel >= other.m_numChannels)
+    {
+        channel = Left;
+    }
+
+    if (&other == this)
+    {
+        // Move the channel to the front, the storage only shrinks
+        if (channel != Left)
+        {
+            std::copy_n(amplitudes(channel), m_numBins, amplitudes(Left));
+            std::copy_n(phases(channel), m_numBins, phases(Left));
+            if (hasInstantaneousFrequencies())
+            {
+                std::copy_n(instantaneousFrequencies(channel), m_numBins, instantaneousFrequencies(Left));
+            }
+            std::copy_n(clipMask(channel), clipMaskWords(), clipMask(Left));
+        }
+    }
+    else
+    {
+        m_numBins = other.m_numBins;
+        m_sampleRate = other.m_sampleRate;
+        m_constantQ = other.m_constantQ;
+        m_frequencies = other.m_frequencies;
+
+        m_amplitudes.resize(m_numBins);
+        m_phases.resize(m_numBins);
+        m_clipMask.resize(clipMaskWords());
+        std::copy_n(other.amplitudes(channel), m_numBins, m_amplitudes.data());
+        std::copy_n(other.phases(channel), m_numBins, m_phases.data());
+        m_instantaneousFrequencies.resize(other.hasInstantaneousFrequencies() ? m_numBins : 0);
+        if (other.hasInstantaneousFrequencies())
+        {
+            std::copy_n(other.instantaneousFrequencies(channel), m_numBins, m_instantaneousFrequencies.data());
+        }
+        std::copy_n(other.clipMask(channel), clipMaskWords(), m_clipMask.data());
+    }
+
+    m_numChannels = 1;
+    m_amplitudes.resize(m_numBins);
+    m_phases.resize(m_numBins);
+    if (hasInstantaneousFrequencies())
+    {
+        m_instantaneousFrequencies.resize(m_numBins);
+    }
+    m_clipMask.resize(clipMaskWords());
 }
@@ -6,92 +6,188 @@
 /*!
  * \brief FrequencySpectrum Class
  *
- * Represents spectrum as series of elements
- * consisting of frequency, amplitude, and phase
+ * Represents spectrum as bins 0..N/2 of an N-point FFT, or as the bands of a
+ * constant-Q transform, stored as structure of arrays: contiguous amplitudes
+ * and phases of every channel, optionally their instantaneous frequencies, and
+ * a bitmask of clipped bins. The frequency axis only depends on the format, so
+ * it is built once per sample rate and shared, read-only, by all spectra of that
+ * format. A stereo spectrum also carries the right channel and the mid/side
+ * spectra derived from both.
  */
 class FrequencySpectrum {
 public:
-    FrequencySpectrum(int numPoints = 0);
+    /*!
+     * \brief Channels held by a spectrum
+     *
+     * A mono spectrum only has Left.
+     */
+    enum Channel {
+        Left,
+        Right,
+        Mid,
+        Side,
+        ChannelCount
+    };
 
-    struct Element {
-        Element()
-        :   frequency(0.0), amplitude(0.0), phase(0.0), clipped(false)
-        { }
+    /*!
+     * \param[in] numBins - number of bins in each channel, N/2 + 1 for an N-point FFT
+     *            or the number of bands of a constant-Q transform
+     * \param[in] numChannels - number of channels
+     */
+    FrequencySpectrum(int numBins = 0, int numChannels = 1);
 
-        /*!
-         * \brief Frequency in Hz
-         */
-        qreal frequency;
+    /*!
+     * \brief Reset spectrum
+     *
+     * Clears amplitudes, phases, instantaneous frequencies and clipping, keeps the frequency axis.
+     */
+    void reset();
 
+    /*!
+     * \brief Number of channels held
+     *
+     * \param[out] int - 1 for mono, ChannelCount for stereo
+     */
+    int channelCount() const;
 
-        /*!
-         * \brief Amplitude in range [0.0, 1.0]
-         */
-        qreal amplitude;
+    /*!
+     * \brief Number of bins in each channel
+     *
+     * \param[out] int - number of bins
+     */
+    int size() const;
 
-        /*!
-         * \brief Phase in range [0.0, 2*PI]
-         */
-        qreal phase;
+    /*!
+     * \brief Sets the frequency axis for a sample rate
+     *
+     * Takes the shared FFT axis of this size and sample rate; does nothing if it is already set.
+     * \param[in] sampleRate - sample rate of the analysed audio in Hz
+     */
+    void setSampleRate(int sampleRate);
 
-        bool clipped;
-    };
+    /*!
+     * \brief Sets the frequency axis of constant-Q bands
+     *
+     * \param[in] frequencies - size() centre frequencies in Hz, rising; shared, not copied
+     * \param[in] sampleRate - sample rate of the analysed audio in Hz
+     */
+    void setConstantQAxis(const QList<float> &frequencies, int sampleRate);
 
-    typedef QList<Element>::iterator iterator;
-    typedef QList<Element>::const_iterator const_iterator;
+    /*!
+     * \brief Checks if the bins are constant-Q bands
+     *
+     * The bands are spaced logarithmically, each is a measurement of its own.
+     */
+    bool isConstantQ() const { return m_constantQ; }
 
     /*!
-     * \brief Reset spectrum
+     * \brief Sample rate of the frequency axis
+     *
+     * \param[out] int - sample rate in Hz, 0 if the axis is not set
      */
-    void reset();
+    int sampleRate() const { return m_sampleRate; }
+
+    /*!
+     * \brief Frequency axis
+     *
+     * \param[out] float* - frequency of each bin in Hz, shared between spectra
+     */
+    const float *frequencies() const;
+
+    /*!
+     * \brief Amplitudes of a channel
+     *
+     * \param[in] channel - channel, below channelCount()
+     * \param[out] float* - amplitude of each bin, in range [0.0, 1.0]
+     */
+    float *amplitudes(Channel channel);
+    const float *amplitudes(Channel channel) const;
+
+    /*!
+     * \brief Phases of a channel
+     *
+     * \param[in] channel - channel, below channelCount()
+     * \param[out] float* - phase of each bin, in range [-PI, PI]
+     */
+    float *phases(Channel channel);
+    const float *phases(Channel channel) const;
 
     /*!
-     * \brief Operator enabling indexing
+     * \brief Enables storage of the instantaneous frequencies
      *
-     * \param[in] index - index
-     * \param[out] Element - element from list
+     * \param[in] enabled - if the spectrum holds instantaneous frequencies
+     */
+    void setInstantaneousFrequenciesEnabled(bool enabled);
+
+    /*!
+     * \brief Checks if the spectrum holds instantaneous frequencies
      */
-    Element& operator[](int index);
+    bool hasInstantaneousFrequencies() const { return !m_instantaneousFrequencies.isEmpty(); }
 
     /*!
-     * \brief Operator enabling indexing
+     * \brief Instantaneous frequencies of a channel
      *
-     * \param[in] index - index
-     * \param[out] Element - element from list
+     * Frequency of the strongest component of each bin, finer than the bin spacing.
+     * \param[in] channel - channel, below channelCount()
+     * \param[out] float* - frequency of each bin in Hz, nullptr if not held
      */
-    const Element& operator[](int index) const;
+    float *instantaneousFrequencies(Channel channel);
+    const float *instantaneousFrequencies(Channel channel) const;
 
     /*!
-     * \brief Iterator of beginning of the class
+     * \brief Clipping bitmask of a channel
      *
-     * \param[out] iterator - iterator of begin
+     * Bit (bin % 32) of word (bin / 32) is set if the amplitude of the bin was clipped to 1.0.
+     * \param[in] channel - channel, below channelCount()
+     * \param[out] quint32* - clipMaskWords() words
+     */
+    quint32 *clipMask(Channel channel);
+    const quint32 *clipMask(Channel channel) const;
+
+    /*!
+     * \brief Number of words in the clipping bitmask of a channel
      */
-    iterator begin();
+    int clipMaskWords() const { return (m_numBins + 31) / 32; }
 
     /*!
-     * \brief Iterator of end of the class
+     * \brief Checks if the amplitude of a bin was clipped
      *
-     * \param[out] iterator - iterator of end
+     * \param[in] channel - channel, below channelCount()
+     * \param[in] bin - bin
      */
-    iterator end();
+    bool isClipped(Channel channel, int bin) const;
 
     /*!
-     * \brief Iterator of beginning of the class
+     * \brief Single channel spectrum
      *
-     * \param[out] iterator - iterator of begin
+     * Channels missing from a mono spectrum fall back to Left.
+     * \param[in] channel - channel to take
+     * \param[out] FrequencySpectrum - spectrum of the channel
      */
-    const_iterator begin() const;
+    FrequencySpectrum channel(Channel channel) const;
 
     /*!
-     * \brief Iterator of end of the class
+     * \brief Copies one channel of another spectrum into this one
      *
-     * \param[out] iterator - iterator of end
+     * This spectrum becomes a single channel spectrum. Its storage is reused, so
+     * nothing is allocated while the size stays the same.
+     * \param[in] other - source spectrum
+     * \param[in] channel - channel to copy, missing channels fall back to Left
      */
-    const_iterator end() const;
+    void assign(const FrequencySpectrum &other, Channel channel);
 
 private:
 
-    QList<Element> m_elements;
+    int                 m_numBins;
+    int                 m_numChannels;
+    int                 m_sampleRate;
+    bool                m_constantQ;
+
+    QList<float>        m_frequencies;
+    QList<float>        m_amplitudes;
+    QList<float>        m_phases;
+    QList<float>        m_instantaneousFrequencies;
+    QList<quint32>      m_clipMask;
 };
 
 #endif // FREQUENCYSPECTRUM_H
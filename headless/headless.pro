@@ -0,0 +1,23 @@
+# Command line analyser without QtWidgets, Qt3D or OpenGL
+# Build with: qmake headless/headless.pro && make
+
+QT       -= gui
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+TARGET   = AudioSpectrumHeadless
+
+include(../analysis.pri)
+
+SOURCES += \
+    main.cpp \
+    spectrumwriter.cpp
+
+HEADERS += \
+    spectrumwriter.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,150 @@
+#include "engine.h"
+#include "fftbenchmark.h"
+#include "fileanalyser.h"
+#include "spectrumwriter.h"
+
+#include <QCoreApplication>
+#include <QTimer>
+
+#include <iostream>
+
+/*!
+ * \brief Prints the command line options
+ */
+static void printUsage()
+{
+    std::cerr <<
+        "usage: AudioSpectrumHeadless [options]\n"
+        "  --output <file>           write spectra to a file instead of stdout\n"
+        "  --binary                  write raw floats instead of text\n"
+        "  --count <n>               stop after n spectra\n"
+        "  --device <name>           capture from the first input whose description contains name\n"
+        "  --list-devices            print the input devices and exit\n"
+        "  --generator <signal>      analyse sweep, multitone, white, pink or impulse instead of a device\n"
+        "  --play-file <file>        analyse a looped WAV file instead of a device\n"
+        "  --speed <factor>          pace of --generator and --play-file, 0 for as fast as possible\n"
+        "  --fps <n>                 spectra per second in the default mode\n"
+        "  --fft-size <samples>      FFT length\n"
+        "  --hop-size <samples>      analyse every hop of samples instead of on a timer\n"
+        "  --analysis-threads <n>    number of FFT worker threads\n"
+        "  --db-scale                map dBFS linearly to the amplitude instead of the log scale\n"
+        "  --db-floor <dB>           level shown as 0.0 with --db-scale, -90 by default\n"
+        "  --db-ceiling <dB>         level shown as 1.0 with --db-scale, 0 by default\n"
+        "  --window <name>           hann, hamming, blackman-harris, kaiser, flat-top or gaussian\n"
+        "  --window-parameter <x>    beta of kaiser (8.6) or sigma of gaussian (0.4)\n"
+        "  --constant-q <bands>      write constant-Q bands between 20 Hz and 20 kHz instead of FFT bins\n"
+        "  --analyse-file <in> <out> analyse a WAV file instead of capturing\n"
+        "  --benchmark-fft           check the approximations, time the FFT paths and exit\n";
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("Audio Spectrum Headless");
+
+    const QStringList arguments = app.arguments();
+    QString outputFile;
+    QString deviceName;
+    bool binary = false;
+    qint64 count = 0;
+    int fps = 0;
+
+    for (int i = 1; i < arguments.count(); ++i)
+    {
+        const QString &argument = arguments.at(i);
+        if (argument == QStringLiteral("--help") || argument == QStringLiteral("-h"))
+        {
+            printUsage();
+            return 0;
+        }
+        else if (argument == QStringLiteral("--benchmark-fft"))
+        {
+            return benchmarkFFT() ? 0 : 1;
+        }
+        else if (argument == QStringLiteral("--analyse-file"))
+        {
+            return analyseFileFromArguments(arguments);
+        }
+        else if (argument == QStringLiteral("--output") && i + 1 < arguments.count())
+        {
+            outputFile = arguments.at(++i);
+        }
+        else if (argument == QStringLiteral("--binary"))
+        {
+            binary = true;
+        }
+        else if (argument == QStringLiteral("--count") && i + 1 < arguments.count())
+        {
+            count = arguments.at(++i).toLongLong();
+        }
+        else if (argument == QStringLiteral("--device") && i + 1 < arguments.count())
+        {
+            deviceName = arguments.at(++i);
+        }
+        else if (argument == QStringLiteral("--fps") && i + 1 < arguments.count())
+        {
+            fps = arguments.at(++i).toInt();
+        }
+    }
+
+    // The analysis options are read by the engine itself, see AnalysisOptions
+    Engine engine;
+
+    if (arguments.contains(QStringLiteral("--list-devices")))
+    {
+        for (const QAudioDevice &device : engine.availableAudioInputDevices())
+        {
+            std::cout << qPrintable(device.description()) << std::endl;
+        }
+        return 0;
+    }
+
+    if (!deviceName.isEmpty())
+    {
+        bool found = false;
+        for (const QAudioDevice &device : engine.availableAudioInputDevices())
+        {
+            if (device.description().contains(deviceName, Qt::CaseInsensitive))
+            {
+                engine.setAudioInputDevice(device);
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+        {
+            std::cerr << "no input device matches " << qPrintable(deviceName) << std::endl;
+            return 1;
+        }
+    }
+
+    if (fps > 0)
+    {
+        engine.FPSchanged(fps);
+    }
+
+    SpectrumWriter writer;
+    if (!writer.open(outputFile, binary))
+    {
+        std::cerr << "cannot open output " << qPrintable(outputFile) << std::endl;
+        return 1;
+    }
+    writer.setLimit(count);
+
+    QObject::connect(&engine, &Engine::spectrumChanged,
+                     &writer, &SpectrumWriter::spectrumChanged);
+    QObject::connect(&writer, &SpectrumWriter::finished,
+                     &app, &QCoreApplication::quit, Qt::QueuedConnection);
+
+    engine.startRecording();
+    const int result = app.exec();
+    engine.stopRecording();
+
+    // Throughput of the whole pipeline, kept off stdout
+    if (writer.count() > 0)
+    {
+        std::cerr << writer.count() << " spectra in " << writer.elapsed() << " ms, "
+                  << engine.droppedFrames() << " frames dropped" << std::endl;
+    }
+    return result;
+}
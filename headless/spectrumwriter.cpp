@@ -0,0 +1,66 @@
+#include "spectrumwriter.h"
+#include "frequencyspectrum.h"
+
+#include <cstdio>
+
+SpectrumWriter::SpectrumWriter(QObject *parent)
+    :   QObject(parent)
+    ,   m_binary(false)
+    ,   m_count(0)
+    ,   m_limit(0)
+{
+}
+
+bool SpectrumWriter::open(const QString &fileName, bool binary)
+{
+    m_binary = binary;
+    if (fileName.isEmpty() || fileName == QStringLiteral("-"))
+    {
+        return m_file.open(stdout, QIODevice::WriteOnly);
+    }
+
+    m_file.setFileName(fileName);
+    return m_file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+}
+
+void SpectrumWriter::spectrumChanged(const FrequencySpectrum &spectrum)
+{
+    // The engine sends an empty spectrum when it stops
+    const int bins = spectrum.size();
+    if (bins < 2 || !m_file.isOpen() || (m_limit > 0 && m_count >= m_limit))
+    {
+        return;
+    }
+
+    if (!m_timer.isValid())
+    {
+        m_timer.start();
+    }
+
+    for (int channel = 0; channel < spectrum.channelCount(); ++channel)
+    {
+        const float *amplitudes = spectrum.amplitudes(FrequencySpectrum::Channel(channel));
+        m_line.clear();
+        if (m_binary)
+        {
+            m_line.append(reinterpret_cast<const char*>(amplitudes), bins * sizeof(float));
+        }
+        else
+        {
+            m_line.append(QByteArray::number(m_count)).append(' ').append(QByteArray::number(channel));
+            for (int bin = 0; bin < bins; ++bin)
+            {
+                m_line.append(' ').append(QByteArray::number(amplitudes[bin], 'g', 6));
+            }
+            m_line.append('\n');
+        }
+        m_file.write(m_line);
+    }
+    m_file.flush();
+
+    ++m_count;
+    if (m_limit > 0 && m_count == m_limit)
+    {
+        emit finished();
+    }
+}
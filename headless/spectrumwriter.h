@@ -0,0 +1,77 @@
+#ifndef SPECTRUMWRITER_H
+#define SPECTRUMWRITER_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+
+class FrequencySpectrum;
+
+/*!
+ * \brief SpectrumWriter Class
+ *
+ * Writes every spectrum it receives to stdout or to a file, and counts them so the
+ * throughput of the pipeline can be reported. Text output is one line per spectrum
+ * and channel: spectrum index, channel index and the amplitudes of bins 0..N/2.
+ * Binary output is the same amplitudes as raw little-endian floats, [channel][bin]
+ * per spectrum, like the body of the FileAnalyser output.
+ */
+class SpectrumWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SpectrumWriter(QObject *parent = nullptr);
+
+    /*!
+     * \brief Opens the output
+     *
+     * \param[in] fileName - output file, empty or "-" for stdout
+     * \param[in] binary - write raw floats instead of text
+     * \return If the output could be opened
+     */
+    bool open(const QString &fileName, bool binary);
+
+    /*!
+     * \brief Sets the number of spectra after which finished() is emitted
+     *
+     * \param[in] count - number of spectra, 0 for no limit
+     */
+    void setLimit(qint64 count) { m_limit = count; }
+
+    /*!
+     * \brief Number of spectra written
+     */
+    qint64 count() const { return m_count; }
+
+    /*!
+     * \brief Time since the first spectrum in milliseconds
+     */
+    qint64 elapsed() const { return m_timer.isValid() ? m_timer.elapsed() : 0; }
+
+public slots:
+
+    /*!
+     * \brief Writes a spectrum
+     *
+     * \param[in] spectrum - spectrum to write
+     */
+    void spectrumChanged(const FrequencySpectrum &spectrum);
+
+signals:
+
+    /*!
+     * \brief The limit of spectra has been reached
+     */
+    void finished();
+
+private:
+    QFile           m_file;
+    bool            m_binary;
+    qint64          m_count;
+    qint64          m_limit;
+    QElapsedTimer   m_timer;
+    QByteArray      m_line;
+};
+
+#endif // SPECTRUMWRITER_H
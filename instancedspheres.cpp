@@ -0,0 +1,197 @@
+#include "instancedspheres.h"
+
+#include <Qt3DCore/qgeometry.h>
+
+#include <Qt3DExtras/qspheregeometry.h>
+
+#include <Qt3DRender/qeffect.h>
+#include <Qt3DRender/qfilterkey.h>
+#include <Qt3DRender/qgraphicsapifilter.h>
+#include <Qt3DRender/qrenderpass.h>
+#include <Qt3DRender/qshaderprogram.h>
+#include <Qt3DRender/qtechnique.h>
+
+#include <QUrl>
+#include <QVector4D>
+
+// Shape of a single sphere
+const int SphereRings = 3;
+const int SphereSlices = 3;
+const float SphereRadius = 0.03f;
+
+// Lighting as in the default QPhongMaterial with a white diffuse colour
+const float LightIntensity = 2.0f;
+const float AmbientLevel = 0.05f;
+
+// Instance attribute: x, y, z and the band index, negative for a final position
+const int InstanceComponents = 4;
+const float FixedPosition = -1.0f;
+
+InstancedSpheres::InstancedSpheres(Qt3DCore::QNode *parent)
+    :   Qt3DCore::QEntity(parent)
+    ,   m_count(0)
+{
+    // One mesh for all spheres
+    Qt3DExtras::QSphereGeometry *geometry = new Qt3DExtras::QSphereGeometry(this);
+    geometry->setRings(SphereRings);
+    geometry->setSlices(SphereSlices);
+    geometry->setRadius(SphereRadius);
+
+    // Coordinates and band of a sphere as an attribute stepped per instance, not per vertex
+    m_instanceBuffer = new Qt3DCore::QBuffer(geometry);
+    m_instanceBuffer->setUsage(Qt3DCore::QBuffer::DynamicDraw);
+
+    m_instanceAttribute = new Qt3DCore::QAttribute(geometry);
+    m_instanceAttribute->setName(QStringLiteral("instanceData"));
+    m_instanceAttribute->setAttributeType(Qt3DCore::QAttribute::VertexAttribute);
+    m_instanceAttribute->setVertexBaseType(Qt3DCore::QAttribute::Float);
+    m_instanceAttribute->setVertexSize(InstanceComponents);
+    m_instanceAttribute->setByteOffset(0);
+    m_instanceAttribute->setByteStride(InstanceComponents * sizeof(float));
+    m_instanceAttribute->setDivisor(1);
+    m_instanceAttribute->setBuffer(m_instanceBuffer);
+    geometry->addAttribute(m_instanceAttribute);
+
+    m_renderer = new Qt3DRender::QGeometryRenderer(this);
+    m_renderer->setGeometry(geometry);
+    m_renderer->setPrimitiveType(Qt3DRender::QGeometryRenderer::Triangles);
+    m_renderer->setInstanceCount(0);
+
+    m_material = createMaterial();
+
+    addComponent(m_renderer);
+    addComponent(m_material);
+}
+
+InstancedSpheres::~InstancedSpheres() = default;
+
+Qt3DRender::QMaterial *InstancedSpheres::createMaterial()
+{
+    Qt3DRender::QMaterial *material = new Qt3DRender::QMaterial(this);
+    Qt3DRender::QEffect *effect = new Qt3DRender::QEffect(material);
+
+    // The same shader pair in two dialects, the renderer picks the supported technique
+    struct TechniqueSource
+    {
+        Qt3DRender::QGraphicsApiFilter::Api api;
+        Qt3DRender::QGraphicsApiFilter::OpenGLProfile profile;
+        int majorVersion;
+        int minorVersion;
+        const char *vertexShader;
+        const char *fragmentShader;
+    };
+    const TechniqueSource sources[] = {
+        { Qt3DRender::QGraphicsApiFilter::OpenGL, Qt3DRender::QGraphicsApiFilter::CoreProfile, 3, 2,
+          "qrc:/shaders/gl3/instancedspheres.vert", "qrc:/shaders/gl3/instancedspheres.frag" },
+        { Qt3DRender::QGraphicsApiFilter::RHI, Qt3DRender::QGraphicsApiFilter::NoProfile, 1, 0,
+          "qrc:/shaders/rhi/instancedspheres.vert", "qrc:/shaders/rhi/instancedspheres.frag" },
+    };
+
+    for (const TechniqueSource &source : sources)
+    {
+        Qt3DRender::QShaderProgram *program = new Qt3DRender::QShaderProgram(effect);
+        program->setVertexShaderCode(Qt3DRender::QShaderProgram::loadSource(QUrl(QString::fromLatin1(source.vertexShader))));
+        program->setFragmentShaderCode(Qt3DRender::QShaderProgram::loadSource(QUrl(QString::fromLatin1(source.fragmentShader))));
+
+        Qt3DRender::QRenderPass *pass = new Qt3DRender::QRenderPass(effect);
+        pass->setShaderProgram(program);
+
+        // The default QForwardRenderer selects techniques by this key
+        Qt3DRender::QFilterKey *filterKey = new Qt3DRender::QFilterKey(effect);
+        filterKey->setName(QStringLiteral("renderingStyle"));
+        filterKey->setValue(QStringLiteral("forward"));
+
+        Qt3DRender::QTechnique *technique = new Qt3DRender::QTechnique(effect);
+        technique->graphicsApiFilter()->setApi(source.api);
+        technique->graphicsApiFilter()->setProfile(source.profile);
+        technique->graphicsApiFilter()->setMajorVersion(source.majorVersion);
+        technique->graphicsApiFilter()->setMinorVersion(source.minorVersion);
+        technique->addFilterKey(filterKey);
+        technique->addRenderPass(pass);
+        effect->addTechnique(technique);
+    }
+
+    m_lightColor = new Qt3DRender::QParameter(QStringLiteral("lightColor"), QColor(Qt::red), material);
+    m_lightPosition = new Qt3DRender::QParameter(QStringLiteral("lightPosition"), QVector3D(), material);
+    material->addParameter(m_lightColor);
+    material->addParameter(m_lightPosition);
+    material->addParameter(new Qt3DRender::QParameter(QStringLiteral("lightIntensity"), LightIntensity, material));
+    material->addParameter(new Qt3DRender::QParameter(QStringLiteral("ambientLevel"), AmbientLevel, material));
+
+    // A vec4 array has the same layout in std140 and in plain uniforms, 4 bands per element
+    m_amplitudeValues = QVariantList(MaxBands / 4, QVariant::fromValue(QVector4D(1.0f, 1.0f, 1.0f, 1.0f)));
+    m_bandAmplitudes = new Qt3DRender::QParameter(QStringLiteral("bandAmplitudes[0]"), m_amplitudeValues, material);
+    material->addParameter(m_bandAmplitudes);
+
+    material->setEffect(effect);
+    return material;
+}
+
+void InstancedSpheres::setCount(int count)
+{
+    m_count = qMax(count, 0);
+    m_instanceData.fill(0.0f, m_count * InstanceComponents);
+    uploadInstances();
+    m_instanceAttribute->setCount(m_count);
+    m_renderer->setInstanceCount(m_count);
+}
+
+void InstancedSpheres::setBaseCoordinates(const float *coordinates, const int *bands)
+{
+    float *data = m_instanceData.data();
+    for (int i = 0; i < m_count; ++i)
+    {
+        Q_ASSERT(bands[i] >= 0 && bands[i] < MaxBands);
+        *data++ = *coordinates++;
+        *data++ = *coordinates++;
+        *data++ = *coordinates++;
+        *data++ = float(bands[i]);
+    }
+    uploadInstances();
+}
+
+void InstancedSpheres::setBandAmplitudes(const float *amplitudes, int count)
+{
+    Q_ASSERT(count <= MaxBands);
+    count = qMin(count, int(MaxBands));
+    for (int i = 0; i < count; i += 4)
+    {
+        QVector4D value(1.0f, 1.0f, 1.0f, 1.0f);
+        for (int k = 0; k < 4 && i + k < count; ++k)
+        {
+            value[k] = amplitudes[i + k];
+        }
+        m_amplitudeValues[i / 4] = QVariant::fromValue(value);
+    }
+    m_bandAmplitudes->setValue(m_amplitudeValues);
+}
+
+void InstancedSpheres::setPositions(const float *positions)
+{
+    float *data = m_instanceData.data();
+    for (int i = 0; i < m_count; ++i)
+    {
+        *data++ = *positions++;
+        *data++ = *positions++;
+        *data++ = *positions++;
+        *data++ = FixedPosition;
+    }
+    uploadInstances();
+}
+
+void InstancedSpheres::setLightColor(const QColor &color)
+{
+    m_lightColor->setValue(color);
+}
+
+void InstancedSpheres::setLightPosition(const QVector3D &position)
+{
+    m_lightPosition->setValue(position);
+}
+
+void InstancedSpheres::uploadInstances()
+{
+    // The whole buffer in one write, Qt3D uploads it to the GPU with the next frame
+    m_instanceBuffer->setData(QByteArray(reinterpret_cast<const char *>(m_instanceData.constData()),
+                                         m_instanceData.size() * int(sizeof(float))));
+}
@@ -0,0 +1,117 @@
+#ifndef INSTANCEDSPHERES_H
+#define INSTANCEDSPHERES_H
+
+#include <QColor>
+#include <QList>
+#include <QVariantList>
+#include <QVector3D>
+
+#include <Qt3DCore/qentity.h>
+#include <Qt3DCore/qattribute.h>
+#include <Qt3DCore/qbuffer.h>
+
+#include <Qt3DRender/qgeometryrenderer.h>
+#include <Qt3DRender/qmaterial.h>
+#include <Qt3DRender/qparameter.h>
+
+/*!
+ * \brief Klasa InstancedSpheres
+ *
+ * Pole jednakowych sfer rysowane jednym wywołaniem instancjonowanym: jedna siatka, jeden materiał
+ * i bufor atrybutów instancji. Każda instancja ma koordynaty bazowe i indeks pasma, a shader
+ * wierzchołków przesuwa ją promieniowo o amplitudę pasma z tablicy uniform, więc na klatkę
+ * przesyłane są tylko amplitudy pasm. Gdy pasm jest więcej niż MaxBands, pozycje mogą być liczone
+ * na CPU i przesyłane całym buforem, jednym zapisem na klatkę. Shadery są w wersji GLSL 150 dla
+ * OpenGL 3.2 core (także programowy llvmpipe) oraz GLSL 450 dla renderera RHI.
+ */
+class InstancedSpheres : public Qt3DCore::QEntity
+{
+    Q_OBJECT
+
+public:
+    // Capacity of the band amplitude array in the shader, a multiple of 4
+    static const int MaxBands = 256;
+
+    explicit InstancedSpheres(Qt3DCore::QNode *parent = nullptr);
+    ~InstancedSpheres();
+
+    /*!
+     * \brief Zmiana liczby sfer
+     *
+     * Pozycje nowych sfer są nieokreślone do następnego setBaseCoordinates() lub setPositions().
+     * \param[in] count - liczba sfer
+     */
+    void setCount(int count);
+
+    /*!
+     * \brief Liczba sfer
+     */
+    int count() const { return m_count; }
+
+    /*!
+     * \brief Ustawienie koordynatów bazowych sfer przesuwanych przez shader
+     *
+     * Pozycja sfery to jej koordynaty bazowe pomnożone przez amplitudę jej pasma z
+     * setBandAmplitudes(). Bufor instancji jest zapisywany tylko tutaj.
+     * \param[in] coordinates - count() trójek x, y, z
+     * \param[in] bands - count() indeksów pasm, poniżej MaxBands
+     */
+    void setBaseCoordinates(const float *coordinates, const int *bands);
+
+    /*!
+     * \brief Ustawienie amplitud pasm
+     *
+     * \param[in] amplitudes - amplitudy pasm, mnożniki koordynatów bazowych
+     * \param[in] count - liczba pasm, najwyżej MaxBands
+     */
+    void setBandAmplitudes(const float *amplitudes, int count);
+
+    /*!
+     * \brief Ustawienie gotowych pozycji wszystkich sfer
+     *
+     * Ścieżka bez przesunięcia w shaderze, cały bufor instancji jest zapisywany przy każdym wywołaniu.
+     * \param[in] positions - count() trójek x, y, z
+     */
+    void setPositions(const float *positions);
+
+    /*!
+     * \brief Ustawienie koloru światła
+     *
+     * \param[in] color - kolor światła
+     */
+    void setLightColor(const QColor &color);
+
+    /*!
+     * \brief Ustawienie pozycji światła punktowego
+     *
+     * \param[in] position - pozycja światła w scenie
+     */
+    void setLightPosition(const QVector3D &position);
+
+private:
+
+    /*!
+     * \brief Stworzenie materiału z technikami dla OpenGL 3.2 core i RHI
+     */
+    Qt3DRender::QMaterial *createMaterial();
+
+    /*!
+     * \brief Przesłanie m_instanceData do bufora instancji
+     */
+    void uploadInstances();
+
+    Qt3DRender::QGeometryRenderer*  m_renderer;
+    Qt3DCore::QBuffer*              m_instanceBuffer;
+    Qt3DCore::QAttribute*           m_instanceAttribute;
+    Qt3DRender::QMaterial*          m_material;
+    Qt3DRender::QParameter*         m_lightColor;
+    Qt3DRender::QParameter*         m_lightPosition;
+    Qt3DRender::QParameter*         m_bandAmplitudes;
+
+    QList<float>                    m_instanceData;
+    QVariantList                    m_amplitudeValues;
+
+    int                             m_count;
+};
+
+#endif // INSTANCEDSPHERES_H
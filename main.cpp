@@ -1,10 +1,48 @@
+#include "fftbenchmark.h"
+#include "fileanalyser.h"
 #include "mainwidget.h"
 #include <QTranslator>
 #include <QApplication>
-#include <iostream>
+
+/*!
+ * \brief Checks for a command line option which runs without the GUI
+ */
+static bool isBatchMode(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (0 == qstrcmp(argv[i], "--benchmark-fft") || 0 == qstrcmp(argv[i], "--analyse-file"))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+ * \brief Runs the batch mode selected on the command line
+ *
+ * --benchmark-fft
+ * --analyse-file <input.wav> <output> [options], see AnalysisOptions
+ */
+static int runBatchMode(const QStringList &arguments)
+{
+    if (arguments.contains(QStringLiteral("--benchmark-fft")))
+    {
+        return benchmarkFFT() ? 0 : 1;
+    }
+    return analyseFileFromArguments(arguments);
+}
 
 int main(int argc, char *argv[])
 {
+    // Batch modes do not need a display
+    if (isBatchMode(argc, argv))
+    {
+        QCoreApplication app(argc, argv);
+        return runBatchMode(app.arguments());
+    }
+
     QApplication app(argc, argv);
 
     app.setApplicationName("Audio Spectrum");
@@ -4,6 +4,7 @@
 #include "qspinbox.h"
 #include "spectrograph.h"
 #include "scene.h"
+#include "3rdparty/fftreal/fftreal_wrapper.h" // For FFTLengthPowerOfTwoMin
 
 #include <QLabel>
 #include <QPushButton>
@@ -25,8 +26,26 @@ const qreal  SpectrumHighFreq       = 20000.0; // Hz
 extern int frames;
 int SpectrumNumBands = 128;
 
+// Range of the bars amount
+const int SpectrumMinBands = 32;
+const int SpectrumMaxBands = 1024;
+
+// Sphere grid of the 3D scene
+int SceneHalos2D = DefaultHalos2D;
+int SceneHalos3D = DefaultHalos3D;
+
+// Range of the sphere grid, halos above InstancedSpheres::MaxBands are moved on the CPU
+const int SceneMinHalos = 3;
+const int SceneMaxHalos2D = 512;
+const int SceneMaxHalos3D = 360;
+
 bool _2D = true;
 
+// Sizes of the button panel controls
+const QSize LanguageButtonSize(40, 20);
+const QSize SmallerButtonSize(30, 30);
+const QSize BiggerButtonSize(140, 30);
+
 std::vector<QString> gradient{"#FF0000 #FF00FF #00FF00 #00FFFF #0000FF",
                                 "#0000FF #00FFFF #00FF00 #FF00FF #FF0000"};
 
@@ -38,11 +57,40 @@ static const char* color[] {
                         QT_TRANSLATE_NOOP("Color", "Blue"),
                         };
 
+// Indexed by FrequencySpectrum::Channel
+static const char* channel[] {
+                        QT_TRANSLATE_NOOP("Channel", "Left"),
+                        QT_TRANSLATE_NOOP("Channel", "Right"),
+                        QT_TRANSLATE_NOOP("Channel", "Mid"),
+                        QT_TRANSLATE_NOOP("Channel", "Side"),
+                        };
+
+// Indexed by WindowFunction::Type
+static const char* windowFunctions[] {
+                        QT_TRANSLATE_NOOP("Window", "Hann"),
+                        QT_TRANSLATE_NOOP("Window", "Hamming"),
+                        QT_TRANSLATE_NOOP("Window", "Blackman-Harris"),
+                        QT_TRANSLATE_NOOP("Window", "Kaiser"),
+                        QT_TRANSLATE_NOOP("Window", "Flat top"),
+                        QT_TRANSLATE_NOOP("Window", "Gaussian"),
+                        };
+
 MainWidget::MainWidget(QWidget *parent)
     :   QWidget(parent)
     ,   m_engine(new Engine(this))
     ,   m_spectrograph(new Spectrograph(this))
+    ,   m_scene(nullptr)
+    ,   view(nullptr)
+    ,   container(nullptr)
+    ,   m_gradientIndex(0)
+    ,   m_colorIndex(0)
 {
+    // Bands requested on the command line set the bars amount
+    if (m_engine->constantQBands() > 0)
+    {
+        SpectrumNumBands = qBound(SpectrumMinBands, m_engine->constantQBands(), SpectrumMaxBands);
+        m_engine->setConstantQ(SpectrumNumBands, SpectrumLowFreq, SpectrumHighFreq);
+    }
     m_spectrograph->setParams(SpectrumNumBands, SpectrumLowFreq, SpectrumHighFreq);
 
     setWindowTitle(tr("Audio Spectrum"));
@@ -53,6 +101,7 @@ MainWidget::MainWidget(QWidget *parent)
     this->setPalette(pal);
 
     m_currentDevice = 0;
+    m_channel = FrequencySpectrum::Left;
     createUi2D();
     m_engine->startRecording();
     connect(m_engine, QOverload<const FrequencySpectrum&>::of(&Engine::spectrumChanged),
@@ -62,7 +111,11 @@ MainWidget::MainWidget(QWidget *parent)
             this, &MainWidget::inputDevicesChanged);
 }
 
-MainWidget::~MainWidget() = default;
+MainWidget::~MainWidget()
+{
+    // The view is owned by its container, the scene only draws into it
+    delete m_scene;
+}
 
 
 //-----------------------------------------------------------------------------
@@ -85,6 +138,17 @@ void MainWidget::barsChanged(const int bars)
 {
     SpectrumNumBands = bars;
     m_spectrograph->setParams(SpectrumNumBands, SpectrumLowFreq, SpectrumHighFreq);
+    if (m_engine->constantQBands() > 0)
+    {
+        m_engine->setConstantQ(SpectrumNumBands, SpectrumLowFreq, SpectrumHighFreq);
+    }
+}
+
+void MainWidget::halosChanged()
+{
+    SceneHalos2D = m_Halos2D->value();
+    SceneHalos3D = m_Halos3D->value();
+    m_scene->setHalos(SceneHalos2D, SceneHalos3D);
 }
 
 void MainWidget::FPSchanged(const int fps)
@@ -92,13 +156,45 @@ void MainWidget::FPSchanged(const int fps)
     m_engine->FPSchanged(fps);
 }
 
+void MainWidget::FFTSizeChanged(const int index)
+{
+    m_engine->setFFTLength(FFTLengthPowerOfTwoMin + index);
+}
+
+void MainWidget::windowChanged(const int index)
+{
+    WindowFunction function;
+    function.type = WindowFunction::Type(index);
+    m_engine->setWindowFunction(function);
+}
+
+void MainWidget::constantQToggled(const bool enabled)
+{
+    m_engine->setConstantQ(enabled ? SpectrumNumBands : 0, SpectrumLowFreq, SpectrumHighFreq);
+}
+
+void MainWidget::channelChanged(const int index)
+{
+    m_channel = FrequencySpectrum::Channel(index);
+    if (_2D)
+    {
+        m_spectrograph->setChannel(m_channel);
+    }
+    else
+    {
+        m_scene->setChannel(m_channel);
+    }
+}
+
 void MainWidget::gradientChanged(const int index)
 {
+    m_gradientIndex = index;
     m_spectrograph->setGradient(gradient[index]);
 }
 
 void MainWidget::colorChanged(const int index)
 {
+    m_colorIndex = index;
     m_scene->setColor(index);
 }
 
@@ -136,12 +232,9 @@ void MainWidget::createUi2D()
 
     // Spectrograph
     windowLayout->addWidget(m_spectrograph);
+    m_spectrograph->show();
 
     // Button panel
-    const QSize LanguageButtonSize(40, 20);
-    const QSize SmallerButtonSize(30, 30);
-    const QSize BiggerButtonSize(140, 30);
-
     QFile styleFile(":pro/style.qss");
     styleFile.open(QFile::ReadOnly);
     QString style(styleFile.readAll());
@@ -189,7 +282,7 @@ void MainWidget::createUi2D()
     m_Bars->setEnabled(true);
     m_Bars->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     m_Bars->setMinimumSize(BiggerButtonSize);
-    m_Bars->setRange(32, 1024);
+    m_Bars->setRange(SpectrumMinBands, SpectrumMaxBands);
     m_Bars->setSuffix(tr(" bars"));
     m_Bars->setValue(SpectrumNumBands);
 
@@ -234,6 +327,7 @@ void MainWidget::createUi2D()
         QString name = "Gradient " + QString::number(i);
         m_Gradient->addItem(name);
     }
+    m_Gradient->setCurrentIndex(m_gradientIndex);
     buttonPanelLayout4->addWidget(m_Gradient);
 
     QWidget *buttonPanel4 = new QWidget(this);
@@ -253,6 +347,7 @@ void MainWidget::createUi2D()
     Buttons->addWidget(buttonPanel1);
     Buttons->addWidget(buttonPanel2);
     Buttons->addWidget(buttonPanel3);
+    createAnalysisPanel(Buttons.get(), style);
     Buttons->addWidget(buttonPanel4);
     Buttons->addWidget(buttonPanel5);
     Buttons->setAlignment(Qt::AlignHCenter);
@@ -275,21 +370,16 @@ void MainWidget::createUi3D()
     m_FPScount = new QSpinBox(this);
     m_Color = new QComboBox(this);
     m_InputDevices = new QComboBox(this);
+    m_Halos2D = new QSpinBox(this);
+    m_Halos3D = new QSpinBox(this);
 
     QHBoxLayout* windowLayout = new QHBoxLayout(this);
 
     // 3D scene
-    container = QWidget::createWindowContainer(view);
-    container->setMinimumSize(QSize(800, 400)); // w, h
     windowLayout->addWidget(container);
-
-    m_scene->setParams(SpectrumLowFreq, SpectrumHighFreq);
+    container->show();
 
     // Button panel
-    const QSize LanguageButtonSize(40, 20);
-    const QSize SmallerButtonSize(30, 30);
-    const QSize BiggerButtonSize(140, 30);
-
     QFile styleFile(":pro/style.qss");
     styleFile.open(QFile::ReadOnly);
     QString style(styleFile.readAll());
@@ -333,6 +423,22 @@ void MainWidget::createUi3D()
     m_Color->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     m_Color->setMinimumSize(BiggerButtonSize);
 
+    m_Halos2D->setStyleSheet(style);
+    m_Halos2D->setEnabled(true);
+    m_Halos2D->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    m_Halos2D->setMinimumSize(SmallerButtonSize);
+    m_Halos2D->setRange(SceneMinHalos, SceneMaxHalos2D);
+    m_Halos2D->setSuffix(tr(" halos"));
+    m_Halos2D->setValue(SceneHalos2D);
+
+    m_Halos3D->setStyleSheet(style);
+    m_Halos3D->setEnabled(true);
+    m_Halos3D->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    m_Halos3D->setMinimumSize(SmallerButtonSize);
+    m_Halos3D->setRange(SceneMinHalos, SceneMaxHalos3D);
+    m_Halos3D->setSuffix(tr(" spheres"));
+    m_Halos3D->setValue(SceneHalos3D);
+
     // 1st Line
     std::unique_ptr<QHBoxLayout> buttonPanelLayout1(new QHBoxLayout);
     buttonPanelLayout1->setAlignment(Qt::AlignRight);
@@ -373,18 +479,30 @@ void MainWidget::createUi3D()
     {
         m_Color->addItem(QCoreApplication::translate("Color", colorName));
     }
+    m_Color->setCurrentIndex(m_colorIndex);
     buttonPanelLayout4->addWidget(m_Color);
 
     QWidget *buttonPanel4 = new QWidget(this);
-    buttonPanel4->setContentsMargins(0, 0, 0, -8);
+    buttonPanel4->setContentsMargins(0, 0, 0, 5);
     buttonPanel4->setLayout(buttonPanelLayout4.release());
 
+    // Sphere grid line
+    std::unique_ptr<QHBoxLayout> buttonPanelLayoutHalos(new QHBoxLayout);
+    buttonPanelLayoutHalos->addWidget(m_Halos2D);
+    buttonPanelLayoutHalos->addWidget(m_Halos3D);
+
+    QWidget *buttonPanelHalos = new QWidget(this);
+    buttonPanelHalos->setContentsMargins(0, 0, 0, -8);
+    buttonPanelHalos->setLayout(buttonPanelLayoutHalos.release());
+
     // Combine
     std::unique_ptr<QVBoxLayout> Buttons(new QVBoxLayout);
     Buttons->addWidget(buttonPanel1);
     Buttons->addWidget(buttonPanel2);
     Buttons->addWidget(buttonPanel3);
+    createAnalysisPanel(Buttons.get(), style);
     Buttons->addWidget(buttonPanel4);
+    Buttons->addWidget(buttonPanelHalos);
     Buttons->setAlignment(Qt::AlignHCenter);
     Buttons->setAlignment(Qt::AlignTop);
 
@@ -397,6 +515,89 @@ void MainWidget::createUi3D()
     setLayout(windowLayout);
 }
 
+void MainWidget::createAnalysisPanel(QVBoxLayout *buttons, const QString &style)
+{
+    m_FFTSize = new QComboBox(this);
+    m_Window = new QComboBox(this);
+    m_Channel = new QComboBox(this);
+    m_ConstantQ = new QPushButton(this);
+
+    m_FFTSize->setStyleSheet(style);
+    m_FFTSize->setEnabled(true);
+    m_FFTSize->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    m_FFTSize->setMinimumSize(BiggerButtonSize);
+
+    m_Window->setStyleSheet(style);
+    m_Window->setEnabled(true);
+    m_Window->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    m_Window->setMinimumSize(BiggerButtonSize);
+
+    m_Channel->setStyleSheet(style);
+    m_Channel->setEnabled(true);
+    m_Channel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    m_Channel->setMinimumSize(BiggerButtonSize);
+
+    m_ConstantQ->setText("CQT");
+    m_ConstantQ->setToolTip(tr("Constant-Q transform"));
+    m_ConstantQ->setStyleSheet(style);
+    m_ConstantQ->setEnabled(true);
+    m_ConstantQ->setCheckable(true);
+    m_ConstantQ->setChecked(m_engine->constantQBands() > 0);
+    m_ConstantQ->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+    m_ConstantQ->setMinimumSize(SmallerButtonSize);
+
+    // FFT length line
+    std::unique_ptr<QHBoxLayout> buttonPanelLayoutFFT(new QHBoxLayout);
+    for (int i = FFTLengthPowerOfTwoMin; i <= FFTLengthPowerOfTwoMax; ++i)
+    {
+        m_FFTSize->addItem("FFT " + QString::number(1 << i));
+    }
+    m_FFTSize->setCurrentIndex(m_engine->fftLengthPowerOfTwo() - FFTLengthPowerOfTwoMin);
+    buttonPanelLayoutFFT->addWidget(m_FFTSize);
+    for (const char* windowName : windowFunctions)
+    {
+        m_Window->addItem(QCoreApplication::translate("Window", windowName));
+    }
+    m_Window->setCurrentIndex(m_engine->windowFunction().type);
+    buttonPanelLayoutFFT->addWidget(m_Window);
+
+    QWidget *buttonPanelFFT = new QWidget(this);
+    buttonPanelFFT->setContentsMargins(0, 0, 0, 5);
+    buttonPanelFFT->setLayout(buttonPanelLayoutFFT.release());
+
+    // Channel line
+    std::unique_ptr<QHBoxLayout> buttonPanelLayoutChannel(new QHBoxLayout);
+    for (const char* channelName : channel)
+    {
+        m_Channel->addItem(QCoreApplication::translate("Channel", channelName));
+    }
+    m_Channel->setCurrentIndex(m_channel);
+    buttonPanelLayoutChannel->addWidget(m_Channel);
+    buttonPanelLayoutChannel->addWidget(m_ConstantQ);
+
+    QWidget *buttonPanelChannel = new QWidget(this);
+    buttonPanelChannel->setContentsMargins(0, 0, 0, 5);
+    buttonPanelChannel->setLayout(buttonPanelLayoutChannel.release());
+
+    buttons->addWidget(buttonPanelFFT);
+    buttons->addWidget(buttonPanelChannel);
+}
+
+void MainWidget::connectAnalysisPanel()
+{
+    connect(m_FFTSize, &QComboBox::currentIndexChanged,
+            this, &MainWidget::FFTSizeChanged);
+
+    connect(m_Window, &QComboBox::currentIndexChanged,
+            this, &MainWidget::windowChanged);
+
+    connect(m_Channel, &QComboBox::currentIndexChanged,
+            this, &MainWidget::channelChanged);
+
+    connect(m_ConstantQ, &QPushButton::toggled,
+            this, &MainWidget::constantQToggled);
+}
+
 void MainWidget::connectUi2D()
 {
     connect(m_plButton, &QPushButton::clicked,
@@ -419,6 +620,8 @@ void MainWidget::connectUi2D()
 
     connect(m_InputDevices, &QComboBox::activated,
             this, &MainWidget::deviceChanged);
+
+    connectAnalysisPanel();
 }
 
 void MainWidget::connectUi3D()
@@ -438,8 +641,16 @@ void MainWidget::connectUi3D()
     connect(m_Color, &QComboBox::currentIndexChanged,
             this, &MainWidget::colorChanged);
 
+    connect(m_Halos2D, &QSpinBox::valueChanged,
+            this, &MainWidget::halosChanged);
+
+    connect(m_Halos3D, &QSpinBox::valueChanged,
+            this, &MainWidget::halosChanged);
+
     connect(m_InputDevices, &QComboBox::activated,
             this, &MainWidget::deviceChanged);
+
+    connectAnalysisPanel();
 }
 
 void MainWidget::clearLayout(QLayout *layout)
@@ -485,6 +696,21 @@ void MainWidget::switchLanguage()
     }
 
     setWindowTitle(tr("Audio Spectrum"));
+    m_ConstantQ->setToolTip(tr("Constant-Q transform"));
+
+    // Renaming in place keeps the selection and does not reset the engine window
+    for (int i = 0; i < m_Window->count(); ++i)
+    {
+        m_Window->setItemText(i, QCoreApplication::translate("Window", windowFunctions[i]));
+    }
+
+    int curr_channel = m_Channel->currentIndex();
+    m_Channel->clear();
+    for (const char* channelName : channel)
+    {
+        m_Channel->addItem(QCoreApplication::translate("Channel", channelName));
+    }
+    m_Channel->setCurrentIndex(curr_channel);
 
     if (_2D)
     {
@@ -499,53 +725,73 @@ void MainWidget::switchLanguage()
             m_Color->addItem(QCoreApplication::translate("Color", colorName));
         }
         m_Color->setCurrentIndex(curr_idx);
+        m_Halos2D->setSuffix(tr(" halos"));
+        m_Halos3D->setSuffix(tr(" spheres"));
     }
 }
 
 void MainWidget::switch3D()
 {
-    m_engine->suspend();
-    m_engine->stopRecording();
-
     disconnect(m_plButton, nullptr, nullptr, nullptr);
     disconnect(m_usButton, nullptr, nullptr, nullptr);
     disconnect(m_3DswitchButton, nullptr, nullptr, nullptr);
     disconnect(m_FPScount, nullptr, nullptr, nullptr);
+    disconnect(m_FFTSize, nullptr, nullptr, nullptr);
+    disconnect(m_Window, nullptr, nullptr, nullptr);
+    disconnect(m_Channel, nullptr, nullptr, nullptr);
+    disconnect(m_ConstantQ, nullptr, nullptr, nullptr);
     disconnect(m_Bars, nullptr, nullptr, nullptr);
     disconnect(m_Gradient, nullptr, nullptr, nullptr);
 
+    // The spectrograph is kept for the next switch, only the button panel is rebuilt
+    layout()->removeWidget(m_spectrograph);
+    m_spectrograph->hide();
     clearLayout(layout());
 
     _2D = !_2D;
 
-    view = new Qt3DExtras::Qt3DWindow();
-    m_scene = new Scene(view);
+    // The 3D scene is built on the first switch and kept alive afterwards
+    if (!m_scene)
+    {
+        view = new Qt3DExtras::Qt3DWindow();
+        m_scene = new Scene(view);
+        m_scene->setParams(SpectrumLowFreq, SpectrumHighFreq);
+        container = QWidget::createWindowContainer(view, this);
+        container->setMinimumSize(QSize(800, 400)); // w, h
+    }
+    m_scene->setHalos(SceneHalos2D, SceneHalos3D);
+    m_scene->setChannel(m_channel);
+    m_scene->setPaused(false);
 
     createUi3D();
     connectUi3D();
-    m_engine->startRecording();
 }
 
 void MainWidget::switch2D()
 {
-    m_scene->pause();
-    m_engine->suspend();
-    m_engine->stopRecording();
+    m_scene->setPaused(true);
 
     disconnect(m_plButton, nullptr, nullptr, nullptr);
     disconnect(m_usButton, nullptr, nullptr, nullptr);
     disconnect(m_2DswitchButton, nullptr, nullptr, nullptr);
     disconnect(m_FPScount, nullptr, nullptr, nullptr);
+    disconnect(m_FFTSize, nullptr, nullptr, nullptr);
+    disconnect(m_Window, nullptr, nullptr, nullptr);
+    disconnect(m_Channel, nullptr, nullptr, nullptr);
+    disconnect(m_ConstantQ, nullptr, nullptr, nullptr);
     disconnect(m_Color, nullptr, nullptr, nullptr);
+    disconnect(m_Halos2D, nullptr, nullptr, nullptr);
+    disconnect(m_Halos3D, nullptr, nullptr, nullptr);
 
+    // The 3D scene is kept for the next switch, only the button panel is rebuilt
+    layout()->removeWidget(container);
+    container->hide();
     clearLayout(layout());
 
     _2D = !_2D;
 
-    m_spectrograph = new Spectrograph(this);
-    m_spectrograph->setParams(SpectrumNumBands, SpectrumLowFreq, SpectrumHighFreq);
+    m_spectrograph->setChannel(m_channel);
 
     createUi2D();
     connectUi2D();
-    m_engine->startRecording();
 }
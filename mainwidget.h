@@ -1,6 +1,7 @@
 #ifndef MAINWIDGET_H
 #define MAINWIDGET_H
 
+#include "frequencyspectrum.h"
 #include "qt3dwindow.h"
 #include "qtranslator.h"
 #include <QAudioDevice>
@@ -8,7 +9,6 @@
 #include <QWidget>
 
 class Engine;
-class FrequencySpectrum;
 class Spectrograph;
 class Scene;
 
@@ -18,6 +18,7 @@ class QMenu;
 class QPushButton;
 class QSpinBox;
 class QComboBox;
+class QVBoxLayout;
 
 /*!
  * \brief Main widget of the application. It is responsible for UI, Engine and changing between scenes.
@@ -46,6 +47,13 @@ public slots:
      */
     void barsChanged(const int bars);
 
+    /*!
+     * \brief Sphere grid of the 3D scene has changed
+     *
+     * Reads both dimensions from their spin boxes.
+     */
+    void halosChanged();
+
     /*!
      * \brief FPS amount has changed
      *
@@ -53,6 +61,35 @@ public slots:
      */
     void FPSchanged(const int fps);
 
+    /*!
+     * \brief FFT length has changed
+     *
+     * \param[in] index - index of selected FFT length
+     */
+    void FFTSizeChanged(const int index);
+
+    /*!
+     * \brief Window function has changed
+     *
+     * \param[in] index - index of selected window, a WindowFunction::Type
+     */
+    void windowChanged(const int index);
+
+    /*!
+     * \brief Displayed channel has changed
+     *
+     * \param[in] index - index of selected channel, a FrequencySpectrum::Channel
+     */
+    void channelChanged(const int index);
+
+    /*!
+     * \brief Constant-Q transform has been switched
+     *
+     * The transform measures one band per bar, so the bands follow the bars amount.
+     * \param[in] enabled - if the spectrum holds constant-Q bands
+     */
+    void constantQToggled(const bool enabled);
+
     /*!
      * \brief New gradient has been selected
      *
@@ -90,6 +127,20 @@ private:
      */
     void createUi3D();
 
+    /*!
+     * \brief Creates the analysis settings shared by both UIs
+     *
+     * FFT length and window line, channel and constant-Q line.
+     * \param[in] buttons - button panel the lines are added to
+     * \param[in] style - style sheet of the controls
+     */
+    void createAnalysisPanel(QVBoxLayout *buttons, const QString &style);
+
+    /*!
+     * \brief Connects signals of the analysis settings
+     */
+    void connectAnalysisPanel();
+
     /*!
      * \brief Connects 2D signals
      */
@@ -111,11 +162,15 @@ private:
 
     /*!
      * \brief Switches from 3D to 2D
+     *
+     * The 3D scene is hidden and kept, the spectrum is routed to the spectrograph.
      */
     void switch2D();
 
     /*!
      * \brief Switched from 2D to 3D
+     *
+     * The 3D scene is built on the first switch only, later switches show it again.
      */
     void switch3D();
 
@@ -124,21 +179,30 @@ private:
 
     Engine*                 m_engine;
     int                     m_currentDevice;
+    FrequencySpectrum::Channel m_channel;
 
     Spectrograph*           m_spectrograph;
     Scene*                  m_scene;
     Qt3DExtras::Qt3DWindow* view;
     QWidget*                container;
+    int                     m_gradientIndex;
+    int                     m_colorIndex;
 
     QPushButton*            m_plButton;
     QPushButton*            m_usButton;
     QPushButton*            m_3DswitchButton;
     QPushButton*            m_2DswitchButton;
     QSpinBox*               m_FPScount;
+    QComboBox*              m_FFTSize;
+    QComboBox*              m_Window;
+    QComboBox*              m_Channel;
+    QPushButton*            m_ConstantQ;
     QSpinBox*               m_Bars;
     QComboBox*              m_InputDevices;
     QComboBox*              m_Gradient;
     QComboBox*              m_Color;
+    QSpinBox*               m_Halos2D;
+    QSpinBox*               m_Halos3D;
 };
 
 #endif // MAINWIDGET_H
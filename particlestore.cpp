@@ -0,0 +1,40 @@
+#include "particlestore.h"
+
+void ParticleStore::resize(int count)
+{
+    // QList::resize keeps the memory when shrinking
+    m_coordinates.resize(3 * count);
+    m_bands.resize(count);
+    m_positions.resize(3 * count);
+}
+
+void ParticleStore::set(int index, const QVector3D &coords, int band)
+{
+    float *coordinates = m_coordinates.data() + 3 * index;
+    float *position = m_positions.data() + 3 * index;
+    coordinates[0] = position[0] = coords.x();
+    coordinates[1] = position[1] = coords.y();
+    coordinates[2] = position[2] = coords.z();
+    m_bands[index] = band;
+}
+
+QVector3D ParticleStore::coords(int index) const
+{
+    const float *coords = m_coordinates.constData() + 3 * index;
+    return QVector3D(coords[0], coords[1], coords[2]);
+}
+
+void ParticleStore::displace(const float *amplitudes)
+{
+    const float *coords = m_coordinates.constData();
+    const int *bands = m_bands.constData();
+    float *position = m_positions.data();
+    const int count = m_bands.count();
+    for (int i = 0; i < count; ++i)
+    {
+        const float amplitude = amplitudes[bands[i]];
+        *position++ = *coords++ * amplitude;
+        *position++ = *coords++ * amplitude;
+        *position++ = *coords++ * amplitude;
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef PARTICLESTORE_H
+#define PARTICLESTORE_H
+
+#include <QList>
+#include <QVector3D>
+
+/*!
+ * \brief Klasa ParticleStore
+ *
+ * Zwykły typ wartościowy przechowujący sfery sceny 3D jako ciągłe tablice: koordynaty bazowe,
+ * indeks pasa każdej sfery i jej aktualną pozycję. Tablice mają układ oczekiwany przez
+ * InstancedSpheres, więc są przekazywane do bufora instancji bez przepakowywania.
+ */
+class ParticleStore
+{
+public:
+    ParticleStore() = default;
+
+    /*!
+     * \brief Liczba sfer
+     */
+    int count() const { return m_bands.count(); }
+
+    /*!
+     * \brief Zmiana liczby sfer
+     *
+     * Pojemność tablic nie maleje, więc pamięć jest przydzielana tylko gdy sfer jest więcej niż
+     * kiedykolwiek wcześniej. Dane nowych sfer są nieokreślone do set().
+     * \param[in] count - liczba sfer
+     */
+    void resize(int count);
+
+    /*!
+     * \brief Ustawienie sfery
+     *
+     * Aktualna pozycja sfery staje się jej koordynatami bazowymi.
+     * \param[in] index - indeks sfery, poniżej count()
+     * \param[in] coords - koordynaty bazowe sfery
+     * \param[in] band - indeks pasa, którego amplituda przesuwa sferę
+     */
+    void set(int index, const QVector3D &coords, int band);
+
+    /*!
+     * \brief Koordynaty bazowe sfery
+     *
+     * \param[in] index - indeks sfery
+     * \param[out] QVector3D - koordynaty bazowe
+     */
+    QVector3D coords(int index) const;
+
+    /*!
+     * \brief Koordynaty bazowe wszystkich sfer
+     *
+     * \param[out] float* - count() trójek x, y, z
+     */
+    const float *baseCoordinates() const { return m_coordinates.constData(); }
+
+    /*!
+     * \brief Indeksy pasów wszystkich sfer
+     *
+     * \param[out] int* - count() indeksów
+     */
+    const int *bands() const { return m_bands.constData(); }
+
+    /*!
+     * \brief Aktualne pozycje wszystkich sfer
+     *
+     * \param[out] float* - count() trójek x, y, z
+     */
+    const float *positions() const { return m_positions.constData(); }
+
+    /*!
+     * \brief Przesunięcie sfer promieniowo o amplitudy ich pasów
+     *
+     * Aktualna pozycja sfery to jej koordynaty bazowe pomnożone przez amplitudę jej pasa.
+     * \param[in] amplitudes - amplitudy pasów, indeksowane indeksem pasa sfery
+     */
+    void displace(const float *amplitudes);
+
+private:
+
+    QList<float>    m_coordinates;
+    QList<int>      m_bands;
+    QList<float>    m_positions;
+};
+
+#endif // PARTICLESTORE_H
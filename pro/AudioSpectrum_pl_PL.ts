@@ -4,50 +4,124 @@
 <context>
     <name>Color</name>
     <message>
-        <location filename="mainwidget.cpp" line="34"/>
+        <location filename="mainwidget.cpp" line="53"/>
         <source>Red</source>
         <translation>Czerwony</translation>
     </message>
     <message>
-        <location filename="mainwidget.cpp" line="35"/>
+        <location filename="mainwidget.cpp" line="54"/>
         <source>Magenta</source>
         <translation>Magenta</translation>
     </message>
     <message>
-        <location filename="mainwidget.cpp" line="36"/>
+        <location filename="mainwidget.cpp" line="55"/>
         <source>Green</source>
         <translation>Zielony</translation>
     </message>
     <message>
-        <location filename="mainwidget.cpp" line="37"/>
+        <location filename="mainwidget.cpp" line="56"/>
         <source>Cyan</source>
         <translation>Cyjanowy</translation>
     </message>
     <message>
-        <location filename="mainwidget.cpp" line="38"/>
+        <location filename="mainwidget.cpp" line="57"/>
         <source>Blue</source>
         <translation>Niebieski</translation>
     </message>
 </context>
+<context>
+    <name>Channel</name>
+    <message>
+        <location filename="mainwidget.cpp" line="62"/>
+        <source>Left</source>
+        <translation>Lewy</translation>
+    </message>
+    <message>
+        <location filename="mainwidget.cpp" line="63"/>
+        <source>Right</source>
+        <translation>Prawy</translation>
+    </message>
+    <message>
+        <location filename="mainwidget.cpp" line="64"/>
+        <source>Mid</source>
+        <translation>Środek</translation>
+    </message>
+    <message>
+        <location filename="mainwidget.cpp" line="65"/>
+        <source>Side</source>
+        <translation>Różnica</translation>
+    </message>
+</context>
+<context>
+    <name>Window</name>
+    <message>
+        <location filename="mainwidget.cpp" line="70"/>
+        <source>Hann</source>
+        <translation>Hanna</translation>
+    </message>
+    <message>
+        <location filename="mainwidget.cpp" line="71"/>
+        <source>Hamming</source>
+        <translation>Hamminga</translation>
+    </message>
+    <message>
+        <location filename="mainwidget.cpp" line="72"/>
+        <source>Blackman-Harris</source>
+        <translation>Blackmana-Harrisa</translation>
+    </message>
+    <message>
+        <location filename="mainwidget.cpp" line="73"/>
+        <source>Kaiser</source>
+        <translation>Kaisera</translation>
+    </message>
+    <message>
+        <location filename="mainwidget.cpp" line="74"/>
+        <source>Flat top</source>
+        <translation>Płaski wierzchołek</translation>
+    </message>
+    <message>
+        <location filename="mainwidget.cpp" line="75"/>
+        <source>Gaussian</source>
+        <translation>Gaussa</translation>
+    </message>
+</context>
 <context>
     <name>MainWidget</name>
     <message>
-        <location filename="mainwidget.cpp" line="48"/>
-        <location filename="mainwidget.cpp" line="487"/>
+        <location filename="mainwidget.cpp" line="96"/>
+        <location filename="mainwidget.cpp" line="698"/>
         <source>Audio Spectrum</source>
         <translation>Audio Spektrum</translation>
     </message>
     <message>
-        <location filename="mainwidget.cpp" line="175"/>
-        <location filename="mainwidget.cpp" line="323"/>
+        <location filename="mainwidget.cpp" line="268"/>
+        <location filename="mainwidget.cpp" line="413"/>
         <source> fps</source>
         <translation> fps</translation>
     </message>
     <message>
-        <location filename="mainwidget.cpp" line="193"/>
-        <location filename="mainwidget.cpp" line="491"/>
+        <location filename="mainwidget.cpp" line="286"/>
+        <location filename="mainwidget.cpp" line="717"/>
         <source> bars</source>
         <translation> prążków</translation>
     </message>
+    <message>
+        <location filename="mainwidget.cpp" line="431"/>
+        <location filename="mainwidget.cpp" line="728"/>
+        <source> halos</source>
+        <translation> pierścieni</translation>
+    </message>
+    <message>
+        <location filename="mainwidget.cpp" line="439"/>
+        <location filename="mainwidget.cpp" line="729"/>
+        <source> spheres</source>
+        <translation> sfer</translation>
+    </message>
+    <message>
+        <location filename="mainwidget.cpp" line="541"/>
+        <location filename="mainwidget.cpp" line="699"/>
+        <source>Constant-Q transform</source>
+        <translation>Transformacja stałego Q</translation>
+    </message>
 </context>
 </TS>
@@ -0,0 +1,88 @@
+#include "ringbuffer.h"
+
+#include <cstring>
+
+RingBuffer::RingBuffer(qint64 capacity)
+    :   m_capacity(0)
+    ,   m_writePosition(0)
+    ,   m_reservePosition(0)
+{
+    resize(capacity);
+}
+
+RingBuffer::~RingBuffer() = default;
+
+void RingBuffer::resize(qint64 capacity)
+{
+    Q_ASSERT(capacity >= 0);
+    m_data.resize(capacity);
+    m_capacity = capacity;
+    clear();
+}
+
+void RingBuffer::clear()
+{
+    m_data.fill(0);
+    m_writePosition.store(0, std::memory_order_relaxed);
+    m_reservePosition.store(0, std::memory_order_relaxed);
+}
+
+qint64 RingBuffer::writePosition() const
+{
+    return m_writePosition.load(std::memory_order_acquire);
+}
+
+char *RingBuffer::beginWrite(qint64 maxLength, qint64 *length)
+{
+    Q_ASSERT(m_capacity > 0);
+    const qint64 position = m_writePosition.load(std::memory_order_relaxed);
+    const qint64 offset = position % m_capacity;
+
+    *length = qMin(qMin(maxLength, m_capacity - offset), qMax(m_capacity / 4, qint64(1)));
+
+    // Announce the region before touching it, so that a reader copying
+    // concurrently can tell that its window may have been overwritten
+    m_reservePosition.store(position + *length, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return m_data.data() + offset;
+}
+
+void RingBuffer::endWrite(qint64 length)
+{
+    Q_ASSERT(length >= 0);
+    const qint64 position = m_writePosition.load(std::memory_order_relaxed);
+    m_writePosition.store(position + length, std::memory_order_release);
+}
+
+void RingBuffer::write(const char *data, qint64 length)
+{
+    while (length > 0)
+    {
+        qint64 chunk = 0;
+        char *region = beginWrite(length, &chunk);
+        memcpy(region, data, chunk);
+        endWrite(chunk);
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+bool RingBuffer::read(qint64 position, char *data, qint64 length) const
+{
+    const qint64 end = m_writePosition.load(std::memory_order_acquire);
+    if (position < 0 || length > m_capacity || position + length > end || position < end - m_capacity)
+    {
+        return false;
+    }
+
+    const qint64 offset = position % m_capacity;
+    const qint64 first = qMin(length, m_capacity - offset);
+    memcpy(data, m_data.constData() + offset, first);
+    memcpy(data + first, m_data.constData(), length - first);
+
+    // The producer may have lapped us while copying
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const qint64 reserved = m_reservePosition.load(std::memory_order_relaxed);
+    return position >= reserved - m_capacity;
+}
@@ -0,0 +1,96 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <QtCore/qglobal.h>
+#include <QByteArray>
+
+#include <atomic>
+
+/*!
+ * \brief RingBuffer Class
+ *
+ * Fixed-size single-producer/single-consumer byte ring used for continuous capture.
+ * The producer never blocks: once the ring is full the oldest data is overwritten.
+ * Data is addressed by its absolute position in the stream, so the consumer can
+ * read any window that is still held by the ring, also when it wraps around the end.
+ */
+class RingBuffer
+{
+public:
+    explicit RingBuffer(qint64 capacity = 0);
+    ~RingBuffer();
+
+    /*!
+     * \brief Resizes the ring and drops its content
+     *
+     * Must not be called while the producer or the consumer is active.
+     * \param[in] capacity - new capacity in bytes
+     */
+    void resize(qint64 capacity);
+
+    /*!
+     * \brief Drops the content and rewinds the stream position to 0
+     *
+     * Must not be called while the producer or the consumer is active.
+     */
+    void clear();
+
+    /*!
+     * \brief Capacity of the ring
+     *
+     * \param[out] m_capacity - capacity in bytes
+     */
+    qint64 capacity() const { return m_capacity; }
+
+    /*!
+     * \brief Total amount of bytes written since the last clear
+     *
+     * \param[out] qint64 - stream position one past the newest byte
+     */
+    qint64 writePosition() const;
+
+    /*!
+     * \brief Reserves a contiguous region for writing (producer side)
+     *
+     * The region never crosses the end of the storage and never exceeds a quarter of
+     * the capacity, so the consumer always has older data left to read.
+     * \param[in] maxLength - amount of bytes the producer would like to write
+     * \param[out] length - size of the reserved region in bytes
+     * \param[out] char* - beginning of the reserved region
+     */
+    char *beginWrite(qint64 maxLength, qint64 *length);
+
+    /*!
+     * \brief Publishes bytes written into the region returned by beginWrite (producer side)
+     *
+     * \param[in] length - amount of bytes actually written
+     */
+    void endWrite(qint64 length);
+
+    /*!
+     * \brief Copies data into the ring (producer side)
+     *
+     * \param[in] data - source data
+     * \param[in] length - amount of bytes to copy
+     */
+    void write(const char *data, qint64 length);
+
+    /*!
+     * \brief Copies a window of the stream out of the ring (consumer side)
+     *
+     * \param[in] position - absolute stream position of the first byte
+     * \param[out] data - destination of length bytes
+     * \param[in] length - amount of bytes to copy
+     * \param[out] bool - false if the window was not written yet or has been overwritten
+     */
+    bool read(qint64 position, char *data, qint64 length) const;
+
+private:
+    QByteArray              m_data;
+    qint64                  m_capacity;
+
+    std::atomic<qint64>     m_writePosition;
+    std::atomic<qint64>     m_reservePosition;
+};
+
+#endif // RINGBUFFER_H
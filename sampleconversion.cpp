@@ -0,0 +1,259 @@
+#include "sampleconversion.h"
+
+#include <QtGlobal>
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define SAMPLECONVERSION_SSE2
+#    include <emmintrin.h>
+#endif
+
+namespace {
+
+// Each sample type gives its size, the scale down to range [-1.0, 1.0],
+// a scalar read and, with SSE2, reads of 4 mono or 4 stereo frames.
+
+struct UInt8Samples
+{
+    enum { Size = 1 };
+    static float scale() { return 1.0f / 128.0f; }
+    static float at(const char *ptr) { return float(int(quint8(*ptr)) - 128); }
+
+#if defined(SAMPLECONVERSION_SSE2)
+    static __m128 mono4(const char *ptr)
+    {
+        int bytes;
+        memcpy(&bytes, ptr, sizeof(bytes));
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i words = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero);
+        const __m128i dwords = _mm_unpacklo_epi16(words, zero);
+        return _mm_cvtepi32_ps(_mm_sub_epi32(dwords, _mm_set1_epi32(128)));
+    }
+
+    static void stereo4(const char *ptr, __m128 &left, __m128 &right)
+    {
+        // Widened to signed 16-bit, then split like Int16 frames
+        const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr));
+        const __m128i frames = _mm_sub_epi16(_mm_unpacklo_epi8(bytes, _mm_setzero_si128()), _mm_set1_epi16(128));
+        left = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(frames, 16), 16));
+        right = _mm_cvtepi32_ps(_mm_srai_epi32(frames, 16));
+    }
+#endif
+};
+
+struct Int16Samples
+{
+    enum { Size = 2 };
+    static float scale() { return 1.0f / 32768.0f; }
+    static float at(const char *ptr) { qint16 sample; memcpy(&sample, ptr, sizeof(sample)); return sample; }
+
+#if defined(SAMPLECONVERSION_SSE2)
+    static __m128 mono4(const char *ptr)
+    {
+        // Sign extended by unpacking into the high half
+        const __m128i samples = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr));
+        return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+    }
+
+    static void stereo4(const char *ptr, __m128 &left, __m128 &right)
+    {
+        // Left in the low, right in the high half of each 32-bit lane
+        const __m128i frames = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        left = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(frames, 16), 16));
+        right = _mm_cvtepi32_ps(_mm_srai_epi32(frames, 16));
+    }
+#endif
+};
+
+struct Int32Samples
+{
+    enum { Size = 4 };
+    static float scale() { return 1.0f / 2147483648.0f; }
+    static float at(const char *ptr) { qint32 sample; memcpy(&sample, ptr, sizeof(sample)); return float(sample); }
+
+#if defined(SAMPLECONVERSION_SSE2)
+    static __m128 mono4(const char *ptr)
+    {
+        return _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)));
+    }
+
+    static void stereo4(const char *ptr, __m128 &left, __m128 &right)
+    {
+        const __m128 a = _mm_loadu_ps(reinterpret_cast<const float*>(ptr));
+        const __m128 b = _mm_loadu_ps(reinterpret_cast<const float*>(ptr) + 4);
+        left = _mm_cvtepi32_ps(_mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))));
+        right = _mm_cvtepi32_ps(_mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+    }
+#endif
+};
+
+struct FloatSamples
+{
+    enum { Size = 4 };
+    static float scale() { return 1.0f; }
+    static float at(const char *ptr) { float sample; memcpy(&sample, ptr, sizeof(sample)); return sample; }
+
+#if defined(SAMPLECONVERSION_SSE2)
+    static __m128 mono4(const char *ptr)
+    {
+        return _mm_loadu_ps(reinterpret_cast<const float*>(ptr));
+    }
+
+    static void stereo4(const char *ptr, __m128 &left, __m128 &right)
+    {
+        const __m128 a = _mm_loadu_ps(reinterpret_cast<const float*>(ptr));
+        const __m128 b = _mm_loadu_ps(reinterpret_cast<const float*>(ptr) + 4);
+        left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+#endif
+};
+
+template <class Samples>
+void deinterleaveSamples(const char *data, int numFrames, int bytesPerFrame,
+                         const float *window, float *left, float *right)
+{
+    int i = 0;
+
+#if defined(SAMPLECONVERSION_SSE2)
+    const __m128 scale = _mm_set1_ps(Samples::scale());
+
+    if (right && 2 * Samples::Size == bytesPerFrame)
+    {
+        for ( ; i + 4 <= numFrames; i += 4)
+        {
+            __m128 l;
+            __m128 r;
+            Samples::stereo4(data + i * bytesPerFrame, l, r);
+            const __m128 w = _mm_mul_ps(_mm_loadu_ps(window + i), scale);
+            _mm_storeu_ps(left + i, _mm_mul_ps(l, w));
+            _mm_storeu_ps(right + i, _mm_mul_ps(r, w));
+        }
+    }
+    else if (!right && Samples::Size == bytesPerFrame)
+    {
+        for ( ; i + 4 <= numFrames; i += 4)
+        {
+            const __m128 w = _mm_mul_ps(_mm_loadu_ps(window + i), scale);
+            _mm_storeu_ps(left + i, _mm_mul_ps(Samples::mono4(data + i * bytesPerFrame), w));
+        }
+    }
+#endif
+
+    // Remaining frames and other layouts
+    for ( ; i < numFrames; ++i)
+    {
+        const char *frame = data + i * bytesPerFrame;
+        const float w = Samples::scale() * window[i];
+        left[i] = Samples::at(frame) * w;
+        if (right)
+        {
+            right[i] = Samples::at(frame + Samples::Size) * w;
+        }
+    }
+}
+
+template <class Samples>
+void windowInterleavedSamples(const char *data, int numFrames,
+                              const float *window, float *interleaved)
+{
+    const int bytesPerFrame = 2 * Samples::Size;
+    int i = 0;
+
+#if defined(SAMPLECONVERSION_SSE2)
+    const __m128 scale = _mm_set1_ps(Samples::scale());
+
+    // 4 frames per step, each window value applied to both channels
+    for ( ; i + 4 <= numFrames; i += 4)
+    {
+        __m128 l;
+        __m128 r;
+        Samples::stereo4(data + i * bytesPerFrame, l, r);
+        const __m128 w = _mm_mul_ps(_mm_loadu_ps(window + i), scale);
+        l = _mm_mul_ps(l, w);
+        r = _mm_mul_ps(r, w);
+        _mm_storeu_ps(interleaved + 2 * i, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(interleaved + 2 * i + 4, _mm_unpackhi_ps(l, r));
+    }
+#endif
+
+    for ( ; i < numFrames; ++i)
+    {
+        const char *frame = data + i * bytesPerFrame;
+        const float w = Samples::scale() * window[i];
+        interleaved[2 * i] = Samples::at(frame) * w;
+        interleaved[2 * i + 1] = Samples::at(frame + Samples::Size) * w;
+    }
+}
+
+} // namespace
+
+int bytesPerSample(QAudioFormat::SampleFormat format)
+{
+    switch (format)
+    {
+    case QAudioFormat::UInt8:
+        return UInt8Samples::Size;
+    case QAudioFormat::Int16:
+        return Int16Samples::Size;
+    case QAudioFormat::Int32:
+        return Int32Samples::Size;
+    case QAudioFormat::Float:
+        return FloatSamples::Size;
+    default:
+        return 0;
+    }
+}
+
+void deinterleave(QAudioFormat::SampleFormat format, const char *data, int numFrames, int bytesPerFrame,
+                  const float *window, float *left, float *right)
+{
+    switch (format)
+    {
+    case QAudioFormat::UInt8:
+        deinterleaveSamples<UInt8Samples>(data, numFrames, bytesPerFrame, window, left, right);
+        break;
+    case QAudioFormat::Int16:
+        deinterleaveSamples<Int16Samples>(data, numFrames, bytesPerFrame, window, left, right);
+        break;
+    case QAudioFormat::Int32:
+        deinterleaveSamples<Int32Samples>(data, numFrames, bytesPerFrame, window, left, right);
+        break;
+    case QAudioFormat::Float:
+        deinterleaveSamples<FloatSamples>(data, numFrames, bytesPerFrame, window, left, right);
+        break;
+    default:
+        Q_ASSERT(false);
+        memset(left, 0, numFrames * sizeof(float));
+        if (right)
+        {
+            memset(right, 0, numFrames * sizeof(float));
+        }
+        break;
+    }
+}
+
+void windowInterleaved(QAudioFormat::SampleFormat format, const char *data, int numFrames,
+                       const float *window, float *interleaved)
+{
+    switch (format)
+    {
+    case QAudioFormat::UInt8:
+        windowInterleavedSamples<UInt8Samples>(data, numFrames, window, interleaved);
+        break;
+    case QAudioFormat::Int16:
+        windowInterleavedSamples<Int16Samples>(data, numFrames, window, interleaved);
+        break;
+    case QAudioFormat::Int32:
+        windowInterleavedSamples<Int32Samples>(data, numFrames, window, interleaved);
+        break;
+    case QAudioFormat::Float:
+        windowInterleavedSamples<FloatSamples>(data, numFrames, window, interleaved);
+        break;
+    default:
+        Q_ASSERT(false);
+        memset(interleaved, 0, 2 * numFrames * sizeof(float));
+        break;
+    }
+}
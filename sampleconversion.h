@@ -0,0 +1,46 @@
+#ifndef SAMPLECONVERSION_H
+#define SAMPLECONVERSION_H
+
+#include <QAudioFormat>
+
+/*!
+ * \brief Size of one sample in bytes
+ *
+ * \param[in] format - sample format
+ * \param[out] int - size of the sample, 0 for an unknown format
+ */
+int bytesPerSample(QAudioFormat::SampleFormat format);
+
+/*!
+ * \brief Converts interleaved PCM frames to windowed samples
+ *
+ * Splits the first two channels of each frame into separate arrays, scales
+ * them to range [-1.0, 1.0] and multiplies them by the window, in one pass.
+ * UInt8, Int16, Int32 and Float samples are read as they come from the
+ * device; mono and stereo frames are converted with SSE2 where available.
+ * \param[in] format - sample format
+ * \param[in] data - interleaved frames
+ * \param[in] numFrames - number of frames
+ * \param[in] bytesPerFrame - size of a frame in bytes
+ * \param[in] window - window function, numFrames values
+ * \param[out] left - samples of the first channel
+ * \param[out] right - samples of the second channel, nullptr to skip it
+ */
+void deinterleave(QAudioFormat::SampleFormat format, const char *data, int numFrames, int bytesPerFrame,
+                  const float *window, float *left, float *right);
+
+/*!
+ * \brief Converts interleaved stereo frames to windowed samples
+ *
+ * Keeps the channels interleaved, as needed by FFTRealStereoWrapper, and
+ * applies the same window value to both samples of a frame.
+ * \param[in] format - sample format
+ * \param[in] data - interleaved frames of exactly two channels
+ * \param[in] numFrames - number of frames
+ * \param[in] window - window function, numFrames values
+ * \param[out] interleaved - 2 * numFrames samples
+ */
+void windowInterleaved(QAudioFormat::SampleFormat format, const char *data, int numFrames,
+                       const float *window, float *interleaved);
+
+#endif // SAMPLECONVERSION_H
@@ -1,15 +1,15 @@
 #include "scene.h"
-#include "utils.h"
 
 Scene::Scene(Qt3DExtras::Qt3DWindow *view)
     :   m_root(view)
+    ,   m_halos2D(0)
+    ,   m_halos3D(0)
+    ,   m_shaderDisplacement(false)
+    ,   m_lowFreq(0.0)
+    ,   m_highFreq(0.0)
+    ,   m_channel(FrequencySpectrum::Left)
 {
     m_paused = false;
-    for (int i = 0; i < halos_2D; ++i)
-    {
-        m_amp_prev[i] = 1.0;
-        m_amp[i] = 1.0;
-    }
 
     // Root entity
     m_rootEntity = new Qt3DCore::QEntity();
@@ -24,30 +24,76 @@ Scene::Scene(Qt3DExtras::Qt3DWindow *view)
     m_cameraEntity->setUpVector(QVector3D(1, 0, 1));
     m_cameraEntity->setViewCenter(QVector3D(0, 0, 0));
 
-    // Light
-    m_lightEntity = new Qt3DCore::QEntity(m_rootEntity);
-    m_light = new Qt3DRender::QPointLight(m_lightEntity);
-    m_light->setColor("red");
-    m_light->setIntensity(2);
-    m_lightEntity->addComponent(m_light);
-    m_lightTransform = new Qt3DCore::QTransform(m_lightEntity);
-    m_lightTransform->setTranslation(m_cameraEntity->position());
-    m_lightEntity->addComponent(m_lightTransform);
+    // Spheres, lit by a point light at the camera
+    m_spheres = new InstancedSpheres(m_rootEntity);
+    m_spheres->setLightColor("red");
+    m_spheres->setLightPosition(m_cameraEntity->position());
+
+    // The instances spread far beyond the bounds of the single mesh
+    m_root->defaultFrameGraph()->setFrustumCullingEnabled(false);
 
     // Set root object of the scene
     view->setRootEntity(m_rootEntity);
 
+    setHalos(DefaultHalos2D, DefaultHalos3D);
+}
+
+Scene::~Scene() = default;
+
+void Scene::setPaused(bool paused)
+{
+    m_paused = paused;
+}
+
+void Scene::setParams(qreal lowFreq, qreal highFreq)
+{
+    Q_ASSERT(highFreq > lowFreq);
+    m_lowFreq = lowFreq;
+    m_highFreq = highFreq;
+    m_plan.setBars(m_halos2D, lowFreq, highFreq, 19000);
+    updateSphere();
+}
+
+void Scene::setHalos(int halos2D, int halos3D)
+{
+    halos2D = qMax(halos2D, 1);
+    halos3D = qMax(halos3D, 1);
+    if (halos2D == m_halos2D && halos3D == m_halos3D)
+    {
+        return;
+    }
+
+    // Halos kept from before keep their amplitudes, new ones start at rest
+    m_amp.resize(halos2D, 1.0);
+    m_amp_prev.resize(halos2D, 1.0);
+    m_haloValues.resize(halos2D, 0.0f);
+    m_bandAmplitudes.resize(halos2D, 1.0f);
+
+    m_halos2D = halos2D;
+    m_halos3D = halos3D;
+    layoutHalos();
+
+    if (m_highFreq > m_lowFreq)
+    {
+        m_plan.setBars(m_halos2D, m_lowFreq, m_highFreq, 19000);
+    }
+    updateSphere();
+}
+
+void Scene::layoutHalos()
+{
     double radius = 3;
-    double angle_increment_2D = 170 / halos_2D;
-    double angle_increment_3D = 360 / halos_3D;
+    double angle_increment_2D = 170.0 / m_halos2D;
+    double angle_increment_3D = 360.0 / m_halos3D;
 
-    // Create sphere 10x24
-    for (int i = 0; i < halos_2D; ++i)
+    // Storage grows only, shrinking the grid keeps its capacity
+    m_particles.resize(m_halos2D * m_halos3D);
+    for (int i = 0; i < m_halos2D; ++i)
     {
-        for (int j = 0; j < halos_3D; ++j)
+        for (int j = 0; j < m_halos3D; ++j)
         {
-            int angle_2D = i * angle_increment_2D + 10;
-            int angle_3D = j * angle_increment_3D;
+            double angle_2D = i * angle_increment_2D + 10;
+            double angle_3D = j * angle_increment_3D;
             double radians_2D = qDegreesToRadians(angle_2D);
             double radians_3D = qDegreesToRadians(angle_3D);
 
@@ -55,24 +101,22 @@ Scene::Scene(Qt3DExtras::Qt3DWindow *view)
             float pos_y = radius * cos(radians_3D) * sin(radians_2D);
             float pos_z = radius * cos(radians_2D);
 
-            m_sphere[i][j] = new Sphere(m_rootEntity, QVector3D(pos_x, pos_y, pos_z));
+            m_particles.set(i * m_halos3D + j, QVector3D(pos_x, pos_y, pos_z), i);
         }
     }
-}
-
-Scene::~Scene() = default;
 
-void Scene::pause()
-{
-    m_paused = !m_paused;
+    // With few enough halos the shader moves the spheres, only the amplitudes are sent per frame
+    m_spheres->setCount(m_particles.count());
+    m_shaderDisplacement = m_halos2D <= InstancedSpheres::MaxBands;
+    if (m_shaderDisplacement)
+    {
+        m_spheres->setBaseCoordinates(m_particles.baseCoordinates(), m_particles.bands());
+    }
 }
 
-void Scene::setParams(qreal lowFreq, qreal highFreq)
+void Scene::setChannel(FrequencySpectrum::Channel channel)
 {
-    Q_ASSERT(highFreq > lowFreq);
-    m_lowFreq = lowFreq;
-    m_highFreq = highFreq;
-    updateSphere();
+    m_channel = channel;
 }
 
 void Scene::setColor(const int index)
@@ -81,27 +125,27 @@ void Scene::setColor(const int index)
     {
     // Red
     case 0:
-        m_light->setColor("red");
+        m_spheres->setLightColor("red");
         break;
 
     // Magenta
     case 1:
-        m_light->setColor("magenta");
+        m_spheres->setLightColor("magenta");
         break;
 
     // Green
     case 2:
-        m_light->setColor("green");
+        m_spheres->setLightColor("green");
         break;
 
     // Cyan
     case 3:
-        m_light->setColor("cyan");
+        m_spheres->setLightColor("cyan");
         break;
 
     // Blue
     case 4:
-        m_light->setColor("blue");
+        m_spheres->setLightColor("blue");
         break;
 
     default:
@@ -111,14 +155,19 @@ void Scene::setColor(const int index)
 
 void Scene::updateSphere()
 {
-    for (int i = 0; i < halos_2D; ++i)
+    for (int i = 0; i < m_halos2D; ++i)
     {
-        for (int j = 0; j < halos_3D; ++j)
-        {
-            QVector3D vec = m_sphere[i][j]->getCoords();
-            QVector3D new_vec = vec * m_amp[i];
-            m_sphere[i][j]->translateSphere(new_vec);
-        }
+        m_bandAmplitudes[i] = float(m_amp[i]);
+    }
+
+    if (m_shaderDisplacement)
+    {
+        m_spheres->setBandAmplitudes(m_bandAmplitudes.constData(), m_halos2D);
+    }
+    else
+    {
+        m_particles.displace(m_bandAmplitudes.constData());
+        m_spheres->setPositions(m_particles.positions());
     }
 }
 
@@ -128,40 +177,14 @@ void Scene::reset()
     spectrumChanged(m_spectrum);
 }
 
-int Scene::barIndex(qreal frequency, qreal lower, qreal higher) const
-{
-    Q_ASSERT(frequency >= m_lowFreq && frequency < m_highFreq);
-    const int index = floor( (log_a(frequency, 100) - log_a(lower, 100)) / (log_a(higher, 100) - log_a(lower, 100)) * halos_2D );
-    if (index < 0 || index > halos_2D)
-    {
-        Q_ASSERT(false);
-    }
-    return index;
-}
-
 void Scene::updateHalos()
 {
-    for (int i = 0; i < halos_2D; ++i)
+    m_plan.update(m_spectrum);
+    m_plan.maxPerBar(m_spectrum.amplitudes(FrequencySpectrum::Left), nullptr, m_haloValues.data());
+    for (int i = 0; i < m_halos2D; ++i)
     {
         m_amp_prev[i] = m_amp[i];
-        m_amp[i] = 1.0;
-    }
-
-    FrequencySpectrum::const_iterator i = m_spectrum.begin();
-    const FrequencySpectrum::const_iterator end = m_spectrum.end();
-    qreal lower = 0;
-    for ( ; i != end; ++i)
-    {
-        const FrequencySpectrum::Element e = *i;
-        if (e.frequency >= m_lowFreq && e.frequency < m_highFreq)
-        {
-            if (lower == 0)
-            {
-                lower = e.frequency;
-            }
-            int idx = barIndex(e.frequency, lower, 19000);
-            m_amp[idx] = qMax(m_amp[idx], 1.0 + e.amplitude * bass_amp);
-        }
+        m_amp[i] = 1.0 + m_haloValues[i] * bass_amp;
     }
 }
 
@@ -178,13 +201,13 @@ qreal Scene::measureAmp(qreal amplitude) const
 void Scene::smoothBars()
 {
     // left sided
-    for (int i = 1; i < halos_2D - 1; ++i)
+    for (int i = 1; i < m_halos2D - 1; ++i)
     {
         m_amp[i] = m_amp[i - 1] * 0.2 + m_amp[i] * 0.6 + m_amp[i + 1] * 0.2;
     }
 
     //right sided
-    for (int i = halos_2D - 2; i > 0; --i)
+    for (int i = m_halos2D - 2; i > 0; --i)
     {
         m_amp[i] = m_amp[i - 1] * 0.2 + m_amp[i] * 0.6 + m_amp[i + 1] * 0.2;
     }
@@ -192,7 +215,7 @@ void Scene::smoothBars()
 
 void Scene::addDelay()
 {
-    for (int i = 0; i < halos_2D; ++i)
+    for (int i = 0; i < m_halos2D; ++i)
     {
         m_amp[i] = m_amp[i] + (m_amp_prev[i] - m_amp[i]) * 0.6;
     }
@@ -202,7 +225,7 @@ void Scene::spectrumChanged(const FrequencySpectrum &spectrum)
 {
     if (m_paused == false)
     {
-        m_spectrum = spectrum;
+        m_spectrum.assign(spectrum, m_channel);
         updateHalos();
         smoothBars();
         addDelay();
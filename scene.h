@@ -1,7 +1,9 @@
 #ifndef SCENE_H
 #define SCENE_H
 
-#include "sphere.h"
+#include "instancedspheres.h"
+#include "particlestore.h"
+#include "binningplan.h"
 #include "frequencyspectrum.h"
 
 #include <QGuiApplication>
@@ -15,25 +17,25 @@
 
 #include <Qt3DRender/qrenderpass.h>
 #include <Qt3DRender/qsceneloader.h>
-#include <Qt3DRender/qpointlight.h>
 
 #include <Qt3DRender/qrenderaspect.h>
 #include <Qt3DExtras/qforwardrenderer.h>
 
 #include <Qt3DExtras/qt3dwindow.h>
 
-#define halos_2D 20 // horizontal
-#define halos_3D 35 // vertical
+// Default number of sphere halos
+const int DefaultHalos2D = 20; // horizontal
+const int DefaultHalos3D = 35; // vertical
 
 #define bass_amp 0.3
 
-class Sphere;
-
 /*!
  * \brief Klasa Scene
  *
  * Klasa odpowiedzialna za stworzenie sceny 3D, stworzenie odpowiednich pasów sfer
- * w zależności od zdefiniowanych ich ilości.
+ * w zależności od zdefiniowanych ich ilości. Wszystkie sfery są rysowane jednym wywołaniem
+ * instancjonowanym. Promieniowe przesunięcie sfer o amplitudę pasa liczy shader, więc na klatkę
+ * do GPU trafia tylko m_amp; dla pasów ponad pojemność shadera pozycje są liczone na CPU.
  */
 class Scene : public Qt3DExtras::Qt3DWindow
 {
@@ -51,6 +53,26 @@ public:
      */
     void setParams(qreal lowFreq, qreal highFreq);
 
+    /*!
+     * \brief Zmiana wymiarów siatki sfer
+     *
+     * Pamięć jest przydzielana tylko gdy siatka rośnie ponad dotychczasowy rozmiar, a pasy
+     * istniejące wcześniej zachowują swoje amplitudy. Sfery są rozmieszczane od nowa.
+     * \param[in] halos2D - liczba pasów w poziomie, każdy odpowiada jednemu pasmu częstotliwości
+     * \param[in] halos3D - liczba sfer w każdym pasie
+     */
+    void setHalos(int halos2D, int halos3D);
+
+    /*!
+     * \brief Liczba pasów w poziomie
+     */
+    int halos2D() const { return m_halos2D; }
+
+    /*!
+     * \brief Liczba sfer w każdym pasie
+     */
+    int halos3D() const { return m_halos3D; }
+
     /*!
      * \brief Ustawienie koloru światła
      *
@@ -59,9 +81,18 @@ public:
     void setColor(const int index);
 
     /*!
-     * \brief Metoda odpowiedzialna za zatrzymanie aktualizowania sceny
+     * \brief Wybór kanału wyświetlanego widma
+     *
+     * \param[in] channel - kanał (L/R lub M/S)
+     */
+    void setChannel(FrequencySpectrum::Channel channel);
+
+    /*!
+     * \brief Metoda odpowiedzialna za zatrzymanie i wznowienie aktualizowania sceny
+     *
+     * \param[in] paused - czy scena ma być zatrzymana
      */
-    void pause();
+    void setPaused(bool paused);
 
 public slots:
 
@@ -80,19 +111,14 @@ public slots:
 private:
 
     /*!
-     * \brief Metoda odpowiedzialna za zaktualizowanie pozycji sfer na scenie 3D
+     * \brief Rozmieszczenie sfer według aktualnych wymiarów siatki
      */
-    void updateSphere();
+    void layoutHalos();
 
     /*!
-     * \brief Metoda odpowiedzialna za obliczenia ideksu pasma sfer na podstawie częstotliwości
-     *
-     * \param[in] frequency - częstotliwość wejściowa
-     * \param[in] lower - najniższa częstotliwość spektrum
-     * \param[in] higher - najwyższa częstotliwość spektrum
-     * \param[out] int - indeks pasma, do którego pada częstotliwość
+     * \brief Metoda odpowiedzialna za zaktualizowanie pozycji sfer na scenie 3D
      */
-    int barIndex(qreal frequency, qreal lower, qreal higher) const;
+    void updateSphere();
 
     /*!
      * \brief Metoda odpowiedzialna za zaktualizowanie pasm sfery
@@ -122,18 +148,23 @@ private:
     Qt3DExtras::Qt3DWindow*  m_root;
     Qt3DCore::QEntity*       m_rootEntity;
     Qt3DRender::QCamera*     m_cameraEntity;
-    Qt3DCore::QEntity*       m_lightEntity;
-    Qt3DRender::QPointLight* m_light;
-    Qt3DCore::QTransform*    m_lightTransform;
-
-    Sphere*                  m_sphere[halos_2D][halos_3D];
-    qreal                    m_amp[halos_2D];
-    qreal                    m_amp_prev[halos_2D];
+    InstancedSpheres*        m_spheres;
+
+    int                      m_halos2D;
+    int                      m_halos3D;
+    ParticleStore            m_particles;
+    QList<float>             m_bandAmplitudes;
+    bool                     m_shaderDisplacement;
+    QList<qreal>             m_amp;
+    QList<qreal>             m_amp_prev;
+    QList<float>             m_haloValues;
+    BinningPlan              m_plan;
 
     bool                     m_paused;
     qreal                    m_lowFreq;
     qreal                    m_highFreq;
     FrequencySpectrum        m_spectrum;
+    FrequencySpectrum::Channel m_channel;
 };
 
 #endif // SCENE_H
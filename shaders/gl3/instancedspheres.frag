@@ -0,0 +1,20 @@
+#version 150 core
+
+in vec3 worldPosition;
+in vec3 worldNormal;
+
+out vec4 fragColor;
+
+uniform vec4 lightColor;
+uniform vec3 lightPosition;
+uniform float lightIntensity;
+uniform float ambientLevel;
+
+void main()
+{
+    // White diffuse surface lit by a single point light
+    vec3 n = normalize(worldNormal);
+    vec3 s = normalize(lightPosition - worldPosition);
+    float diffuse = max(dot(s, n), 0.0);
+    fragColor = vec4(vec3(ambientLevel) + lightIntensity * diffuse * lightColor.rgb, 1.0);
+}
@@ -0,0 +1,30 @@
+#version 150 core
+
+in vec3 vertexPosition;
+in vec3 vertexNormal;
+in vec4 instanceData;
+
+out vec3 worldPosition;
+out vec3 worldNormal;
+
+uniform mat4 modelMatrix;
+uniform mat3 modelNormalMatrix;
+uniform mat4 viewProjectionMatrix;
+
+// Band amplitudes, four per element
+uniform vec4 bandAmplitudes[64];
+
+void main()
+{
+    // Each instance is the same mesh moved to its own position: the base
+    // coordinates scaled by the amplitude of its band, or as given if w < 0
+    vec3 instancePosition = instanceData.xyz;
+    if (instanceData.w >= 0.0) {
+        int band = int(instanceData.w);
+        instancePosition *= bandAmplitudes[band / 4][band % 4];
+    }
+
+    worldNormal = normalize(modelNormalMatrix * vertexNormal);
+    worldPosition = vec3(modelMatrix * vec4(vertexPosition + instancePosition, 1.0));
+    gl_Position = viewProjectionMatrix * vec4(worldPosition, 1.0);
+}
@@ -0,0 +1,23 @@
+#version 450 core
+
+layout(location = 0) in vec3 worldPosition;
+layout(location = 1) in vec3 worldNormal;
+
+layout(location = 0) out vec4 fragColor;
+
+layout(std140, binding = 2) uniform material_uniforms {
+    vec4 lightColor;
+    vec3 lightPosition;
+    float lightIntensity;
+    float ambientLevel;
+    vec4 bandAmplitudes[64];
+};
+
+void main()
+{
+    // White diffuse surface lit by a single point light
+    vec3 n = normalize(worldNormal);
+    vec3 s = normalize(lightPosition - worldPosition);
+    float diffuse = max(dot(s, n), 0.0);
+    fragColor = vec4(vec3(ambientLevel) + lightIntensity * diffuse * lightColor.rgb, 1.0);
+}
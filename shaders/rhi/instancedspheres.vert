@@ -0,0 +1,63 @@
+#version 450 core
+
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec3 vertexNormal;
+layout(location = 2) in vec4 instanceData;
+
+layout(location = 0) out vec3 worldPosition;
+layout(location = 1) out vec3 worldNormal;
+
+layout(std140, binding = 0) uniform qt3d_render_view_uniforms {
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    mat4 uncorrectedProjectionMatrix;
+    mat4 clipCorrectionMatrix;
+    mat4 viewProjectionMatrix;
+    mat4 inverseViewMatrix;
+    mat4 inverseProjectionMatrix;
+    mat4 inverseViewProjectionMatrix;
+    mat4 viewportMatrix;
+    mat4 inverseViewportMatrix;
+    vec4 textureTransformMatrix;
+    vec3 eyePosition;
+    float aspectRatio;
+    float gamma;
+    float exposure;
+    float time;
+    float yUpInNDC;
+    float yUpInFBO;
+};
+
+layout(std140, binding = 1) uniform qt3d_command_uniforms {
+    mat4 modelMatrix;
+    mat4 inverseModelMatrix;
+    mat4 modelViewMatrix;
+    mat3 modelNormalMatrix;
+    mat4 inverseModelViewMatrix;
+    mat4 modelViewProjection;
+    mat4 inverseModelViewProjectionMatrix;
+};
+
+layout(std140, binding = 2) uniform material_uniforms {
+    vec4 lightColor;
+    vec3 lightPosition;
+    float lightIntensity;
+    float ambientLevel;
+    // Band amplitudes, four per element
+    vec4 bandAmplitudes[64];
+};
+
+void main()
+{
+    // Each instance is the same mesh moved to its own position: the base
+    // coordinates scaled by the amplitude of its band, or as given if w < 0
+    vec3 instancePosition = instanceData.xyz;
+    if (instanceData.w >= 0.0) {
+        int band = int(instanceData.w);
+        instancePosition *= bandAmplitudes[band / 4][band % 4];
+    }
+
+    worldNormal = normalize(modelNormalMatrix * vertexNormal);
+    worldPosition = vec3(modelMatrix * vec4(vertexPosition + instancePosition, 1.0));
+    gl_Position = viewProjectionMatrix * vec4(worldPosition, 1.0);
+}
@@ -0,0 +1,206 @@
+#include "signalgenerator.h"
+
+#include <math.h>
+
+//-----------------------------------------------------------------------------
+// Constants
+//-----------------------------------------------------------------------------
+
+// Peak level, leaves headroom for the sums
+const float Amplitude = 0.5f;
+
+const double SweepStartHz = 20.0;
+const double SweepEndHz = 20000.0;
+const double SweepDurationS = 10.0;
+
+const double MultitoneHz[] = { 110.0, 440.0, 1000.0, 3520.0, 10000.0 };
+const int MultitoneCount = sizeof(MultitoneHz) / sizeof(MultitoneHz[0]);
+
+const int ImpulsesPerSecond = 4;
+
+const quint32 NoiseSeed = 0x12345678u;
+
+const double TwoPi = 2.0 * M_PI;
+
+//-----------------------------------------------------------------------------
+// Constructor and destructor
+//-----------------------------------------------------------------------------
+
+SignalGenerator::SignalGenerator(Waveform waveform, QObject *parent)
+    :   PacedAudioProvider(parent)
+    ,   m_waveform(waveform)
+    ,   m_sampleRate(48000)
+{
+    rewind();
+}
+
+SignalGenerator::~SignalGenerator() = default;
+
+//-----------------------------------------------------------------------------
+// Public functions
+//-----------------------------------------------------------------------------
+
+SignalGenerator::Waveform SignalGenerator::waveformFromName(const QString &name, bool *ok)
+{
+    static const struct
+    {
+        const char *name;
+        Waveform waveform;
+    } names[] = {
+        { "sweep", Sweep },
+        { "multitone", Multitone },
+        { "white", WhiteNoise },
+        { "pink", PinkNoise },
+        { "impulse", Impulse }
+    };
+
+    for (const auto &entry : names)
+    {
+        if (0 == name.compare(QLatin1String(entry.name), Qt::CaseInsensitive))
+        {
+            *ok = true;
+            return entry.waveform;
+        }
+    }
+    *ok = false;
+    return Sweep;
+}
+
+QAudioFormat SignalGenerator::format() const
+{
+    QAudioFormat format;
+    format.setSampleRate(m_sampleRate);
+    format.setChannelCount(2);
+    format.setSampleFormat(QAudioFormat::Float);
+    return format;
+}
+
+//-----------------------------------------------------------------------------
+// Protected functions
+//-----------------------------------------------------------------------------
+
+void SignalGenerator::rewind()
+{
+    m_frame = 0;
+    for (double &phase : m_phase)
+    {
+        phase = 0.0;
+    }
+    m_seed = NoiseSeed;
+    for (auto &channel : m_pink)
+    {
+        for (float &state : channel)
+        {
+            state = 0.0f;
+        }
+    }
+}
+
+void SignalGenerator::render(char *data, qint64 frameCount)
+{
+    float *out = reinterpret_cast<float*>(data);
+    const double sampleRate = m_sampleRate;
+
+    switch (m_waveform)
+    {
+    case Sweep:
+    {
+        // Phase is accumulated rather than taken from the closed form, which loses
+        // precision after a few seconds of float time
+        const qint64 sweepFrames = qint64(SweepDurationS * sampleRate);
+        const double ratio = log(SweepEndHz / SweepStartHz);
+        for (qint64 i = 0; i < frameCount; ++i)
+        {
+            const double frequency = SweepStartHz * exp(ratio * double(m_frame) / double(sweepFrames));
+            const float value = Amplitude * float(sin(m_phase[0]));
+            m_phase[0] = fmod(m_phase[0] + TwoPi * frequency / sampleRate, TwoPi);
+            if (++m_frame == sweepFrames)
+            {
+                m_frame = 0;
+                m_phase[0] = 0.0;
+            }
+            *out++ = value;
+            *out++ = value;
+        }
+        break;
+    }
+    case Multitone:
+    {
+        for (qint64 i = 0; i < frameCount; ++i)
+        {
+            double sum = 0.0;
+            for (int tone = 0; tone < MultitoneCount; ++tone)
+            {
+                sum += sin(m_phase[tone]);
+                m_phase[tone] = fmod(m_phase[tone] + TwoPi * MultitoneHz[tone] / sampleRate, TwoPi);
+            }
+            const float value = Amplitude * float(sum / MultitoneCount);
+            *out++ = value;
+            *out++ = value;
+        }
+        break;
+    }
+    case WhiteNoise:
+    {
+        for (qint64 i = 0; i < 2 * frameCount; ++i)
+        {
+            *out++ = Amplitude * noise();
+        }
+        break;
+    }
+    case PinkNoise:
+    {
+        for (qint64 i = 0; i < frameCount; ++i)
+        {
+            *out++ = Amplitude * pinkNoise(0);
+            *out++ = Amplitude * pinkNoise(1);
+        }
+        break;
+    }
+    case Impulse:
+    {
+        const qint64 period = qMax(1, m_sampleRate / ImpulsesPerSecond);
+        for (qint64 i = 0; i < frameCount; ++i)
+        {
+            const float value = (0 == m_frame) ? Amplitude : 0.0f;
+            if (++m_frame == period)
+            {
+                m_frame = 0;
+            }
+            *out++ = value;
+            *out++ = value;
+        }
+        break;
+    }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Private functions
+//-----------------------------------------------------------------------------
+
+float SignalGenerator::noise()
+{
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    return float(qint32(m_seed)) * (1.0f / 2147483648.0f);
+}
+
+float SignalGenerator::pinkNoise(int channel)
+{
+    // Paul Kellet's refined filter, accurate to 0.05 dB above 9.2 Hz at 44.1 kHz
+    float *b = m_pink[channel];
+    const float white = noise();
+    b[0] = 0.99886f * b[0] + white * 0.0555179f;
+    b[1] = 0.99332f * b[1] + white * 0.0750759f;
+    b[2] = 0.96900f * b[2] + white * 0.1538520f;
+    b[3] = 0.86650f * b[3] + white * 0.3104856f;
+    b[4] = 0.55000f * b[4] + white * 0.5329522f;
+    b[5] = -0.7616f * b[5] - white * 0.0168980f;
+    const float pink = b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + white * 0.5362f;
+    b[6] = white * 0.115926f;
+
+    // Roughly back to the range of the white noise
+    return pink * 0.11f;
+}
@@ -0,0 +1,99 @@
+#ifndef SIGNALGENERATOR_H
+#define SIGNALGENERATOR_H
+
+#include "audioprovider.h"
+
+#include <QString>
+
+/*!
+ * \brief SignalGenerator Class
+ *
+ * Deterministic test source, so the whole pipeline can be profiled without an
+ * audio device. Every start produces the same stream: stereo Float frames of a
+ * logarithmic sine sweep, a sum of sines, white or pink noise, or a train of
+ * impulses. Noise is drawn from a fixed-seed generator, independently per channel.
+ */
+class SignalGenerator : public PacedAudioProvider
+{
+    Q_OBJECT
+
+public:
+
+    /*!
+     * \brief Generated signal
+     *
+     * Sweep - logarithmic sine sweep from 20 Hz to 20 kHz, repeated every 10 s
+     * Multitone - sum of sines at 110 Hz, 440 Hz, 1 kHz, 3.52 kHz and 10 kHz
+     * WhiteNoise - uniform white noise
+     * PinkNoise - white noise filtered to -3 dB per octave
+     * Impulse - single sample impulses, 4 per second
+     */
+    enum Waveform {
+        Sweep,
+        Multitone,
+        WhiteNoise,
+        PinkNoise,
+        Impulse
+    };
+
+    explicit SignalGenerator(Waveform waveform = Sweep, QObject *parent = nullptr);
+    ~SignalGenerator();
+
+    /*!
+     * \brief Parses a waveform name
+     *
+     * \param[in] name - sweep, multitone, white, pink or impulse
+     * \param[out] ok - if the name is known
+     * \param[out] Waveform - waveform of the name
+     */
+    static Waveform waveformFromName(const QString &name, bool *ok);
+
+    QAudioFormat format() const override;
+
+    /*!
+     * \brief Sets the generated signal
+     *
+     * Must not be called while the generator is started.
+     * \param[in] waveform - new signal
+     */
+    void setWaveform(Waveform waveform) { m_waveform = waveform; }
+
+    /*!
+     * \brief Sets the sample rate of the frames
+     *
+     * Must not be called while the generator is started.
+     * \param[in] sampleRate - sample rate in Hz
+     */
+    void setSampleRate(int sampleRate) { m_sampleRate = sampleRate; }
+
+protected:
+
+    void rewind() override;
+    void render(char *data, qint64 frameCount) override;
+
+private:
+
+    /*!
+     * \brief Next uniform value in range [-1.0, 1.0)
+     *
+     * xorshift32, so the stream is the same on every platform and library.
+     */
+    float noise();
+
+    /*!
+     * \brief Next pink noise value of a channel
+     *
+     * \param[in] channel - channel, 0 or 1
+     */
+    float pinkNoise(int channel);
+
+    Waveform            m_waveform;
+    int                 m_sampleRate;
+
+    qint64              m_frame;
+    double              m_phase[5];
+    quint32             m_seed;
+    float               m_pink[2][7];
+};
+
+#endif // SIGNALGENERATOR_H
@@ -1,5 +1,4 @@
 #include "spectrograph.h"
-#include "utils.h"
 
 #include <QPainter>
 
@@ -12,6 +11,7 @@ Spectrograph::Spectrograph(QWidget *parent)
     :   QWidget(parent)
     ,   m_lowFreq(0.0)
     ,   m_highFreq(0.0)
+    ,   m_channel(FrequencySpectrum::Left)
     ,   m_gradient(0,0,rect().width(),0)
 {
     setMinimumSize(800, 400); // w, h
@@ -26,11 +26,19 @@ void Spectrograph::setParams(int numBars, qreal lowFreq, qreal highFreq)
     m_bars.resize(numBars);
     m_lowFreq = lowFreq;
     m_highFreq = highFreq;
+    m_barValues.resize(numBars);
+    m_barClipped.resize(numBars);
+    m_plan.setBars(numBars, lowFreq, highFreq, 20000);
     updateBars();
     m_gradient.setFinalStop(rect().width(),0);
     setGradient("#FF0000 #FF00FF #00FF00 #00FFFF #0000FF");
 }
 
+void Spectrograph::setChannel(FrequencySpectrum::Channel channel)
+{
+    m_channel = channel;
+}
+
 void Spectrograph::setGradient(QString gradient)
 {
     QStringList gradients = gradient.split(" ");
@@ -144,22 +152,10 @@ void Spectrograph::reset()
 
 void Spectrograph::spectrumChanged(const FrequencySpectrum &spectrum)
 {
-    m_spectrum = spectrum;
+    m_spectrum.assign(spectrum, m_channel);
     updateBars();
 }
 
-int Spectrograph::barIndex(qreal frequency, qreal lower, qreal higher) const
-{
-    Q_ASSERT(frequency >= m_lowFreq && frequency < m_highFreq);
-    const int index = floor( (log_a(frequency, 100) - log_a(lower, 100)) / (log_a(higher, 100) - log_a(lower, 100)) * m_bars.count() );
-    if (index < 0 || index >= m_bars.count())
-    {
-        Q_ASSERT(false);
-    }
-
-    return index;
-}
-
 void Spectrograph::fillBars()
 {
     int since, to;
@@ -214,25 +210,21 @@ void Spectrograph::addDelay()
 void Spectrograph::updateBars()
 {
     m_prev_bars = m_bars;
-    m_bars.fill(Bar());
-    FrequencySpectrum::const_iterator i = m_spectrum.begin();
-    const FrequencySpectrum::const_iterator end = m_spectrum.end();
-    qreal lower = 0;
-    for ( ; i != end; ++i)
+    m_plan.update(m_spectrum);
+    m_plan.maxPerBar(m_spectrum.amplitudes(FrequencySpectrum::Left),
+                     m_spectrum.instantaneousFrequencies(FrequencySpectrum::Left), m_barValues.data());
+    m_barClipped.fill(false);
+    m_plan.clippedBars(m_spectrum.clipMask(FrequencySpectrum::Left), m_barClipped.data());
+    for (int i = 0; i < m_bars.count(); ++i)
     {
-        const FrequencySpectrum::Element e = *i;
-        if (e.frequency >= m_lowFreq && e.frequency < m_highFreq)
-        {
-            if (lower == 0)
-            {
-                lower = e.frequency;
-            }
-            Bar &bar = m_bars[barIndex(e.frequency, lower, 20000)];
-            bar.value = qMax(bar.value, e.amplitude);
-            bar.clipped |= e.clipped;
-        }
+        m_bars[i].value = m_barValues[i];
+        m_bars[i].clipped = m_barClipped[i];
+    }
+    // Constant-Q bands are measured for every bar, there is nothing to fill in
+    if (!m_spectrum.isConstantQ())
+    {
+        fillBars();
     }
-    fillBars();
     if (m_bars.count() >= 64)
     {
         smoothBars();
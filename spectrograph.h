@@ -1,6 +1,7 @@
 #ifndef SPECTROGRAPH_H
 #define SPECTROGRAPH_H
 
+#include "binningplan.h"
 #include "frequencyspectrum.h"
 
 #include <QWidget>
@@ -42,6 +43,13 @@ public:
      */
     void setGradient(QString gradient);
 
+    /*!
+     * \brief Wybór kanału wyświetlanego widma
+     *
+     * \param[in] channel - kanał (L/R lub M/S)
+     */
+    void setChannel(FrequencySpectrum::Channel channel);
+
 public slots:
 
     /*!
@@ -59,16 +67,11 @@ public slots:
 
 private:
 
-    /*!
-     * \brief Wyliczenie indeksu prążka na podstawie częstotliwości
-     *
-     * \param[in] frequency - częstotliwość wejściowa, z której wyliczany jest indeks prążka
-     * \param[out] indeks prążka
-     */
-    int barIndex(qreal frequency, qreal lower, qreal higher) const;
-
     /*!
      * \brief Wypełnienie pustych prążków
+     *
+     * Interpoluje paski basu, do których nie trafił żaden prążek FFT. Niepotrzebne dla
+     * widma stałego Q, w którym każdy pasek ma własne pasmo.
      */
     void fillBars();
 
@@ -127,10 +130,14 @@ private:
 
     QList<Bar>          m_bars;
     QList<Bar>          m_prev_bars;
+    QList<float>        m_barValues;
+    QList<bool>         m_barClipped;
+    BinningPlan         m_plan;
     QList<QColor>       mGradientColors;
     qreal               m_lowFreq;
     qreal               m_highFreq;
     FrequencySpectrum   m_spectrum;
+    FrequencySpectrum::Channel m_channel;
     QLinearGradient     m_gradient;
 };
 
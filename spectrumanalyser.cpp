@@ -1,97 +1,82 @@
 #include "spectrumanalyser.h"
-#include "utils.h"
 #include "3rdparty/fftreal/fftreal_wrapper.h"
 
-#include <qmath.h>
 #include <qmetatype.h>
 #include <QAudioFormat>
+#include <QPointer>
 #include <QThread>
 
-// Number of audio samples used to calculate the frequency spectrum
-const int    SpectrumLengthSamples  = PowerOfTwo<FFTLengthPowerOfTwo>::Result;
+//-----------------------------------------------------------------------------
+// Constants
+//-----------------------------------------------------------------------------
+
+// Number of frames queued per worker
+const int QueueDepthPerWorker = 2;
+
+// Workers share the CPU with the capture thread and the GUI
+const int MaxDefaultWorkerCount = 4;
 
-SpectrumAnalyserThread::SpectrumAnalyserThread(QObject *parent)
+SpectrumAnalyserThread::SpectrumAnalyserThread(int powerOfTwo, SpectrumBuffer *buffer, int writer, QObject *parent)
     :   QObject(parent)
-    ,   m_fft(new FFTRealWrapper)
-    ,   m_numSamples(SpectrumLengthSamples)
-    ,   m_window(SpectrumLengthSamples, 0.0)
-    ,   m_input(SpectrumLengthSamples, 0.0)
-    ,   m_output(SpectrumLengthSamples, 0.0)
-    ,   m_spectrum(SpectrumLengthSamples)
-    ,   m_thread(new QThread(this))
+    ,   m_calculator(powerOfTwo)
+    ,   m_buffer(buffer)
+    ,   m_writer(writer)
 {
-    setParent(nullptr);
-    moveToThread(m_thread);
-    m_thread->start();
-    calculateWindow();
 }
 
-SpectrumAnalyserThread::~SpectrumAnalyserThread()
+SpectrumAnalyserThread::~SpectrumAnalyserThread() = default;
+
+void SpectrumAnalyserThread::setWindowFunction(int type, float parameter)
 {
-    delete m_fft;
+    WindowFunction function;
+    function.type = WindowFunction::Type(type);
+    function.parameter = parameter;
+    m_calculator.setWindowFunction(function);
 }
 
-void SpectrumAnalyserThread::setWindowFunction()
+void SpectrumAnalyserThread::setFFTLength(int powerOfTwo)
 {
-    calculateWindow();
+    m_calculator.setFFTLength(powerOfTwo);
 }
 
-void SpectrumAnalyserThread::calculateWindow()
+void SpectrumAnalyserThread::setStereoPacking(bool enabled)
 {
-    for (int i=0; i<m_numSamples; ++i)
-    {
-        DataType x = 0.0;
-        x = 0.5 * (1 - qCos((2 * M_PI * i) / (m_numSamples - 1)));
+    m_calculator.setStereoPacking(enabled);
+}
 
-        m_window[i] = x;
-    }
+void SpectrumAnalyserThread::setAmplitudeScale(int mode, float floor, float ceiling)
+{
+    AmplitudeScale scale;
+    scale.mode = AmplitudeScale::Mode(mode);
+    scale.floor = floor;
+    scale.ceiling = ceiling;
+    m_calculator.setAmplitudeScale(scale);
 }
 
-void SpectrumAnalyserThread::calculateSpectrum(const QByteArray &buffer,
-                                                int inputFrequency,
-                                                int bytesPerFrame)
+void SpectrumAnalyserThread::setInstantaneousFrequency(bool enabled)
 {
-    Q_ASSERT(buffer.size() == m_numSamples * bytesPerFrame);
+    m_calculator.setInstantaneousFrequency(enabled);
+}
 
-    // Initialize data array
-    const char *ptr = buffer.constData();
-    for (int i=0; i < m_numSamples; ++i)
-    {
-        const qint16 pcmSample = *reinterpret_cast<const qint16*>(ptr);
-        // Scale down to range [-1.0, 1.0]
-        const DataType realSample = pcmToReal(pcmSample);
-        const DataType windowedSample = realSample * m_window[i];
-        m_input[i] = windowedSample;
-        ptr += bytesPerFrame;
-    }
+void SpectrumAnalyserThread::setConstantQ(int bands, float lowFreq, float highFreq)
+{
+    m_calculator.setConstantQ(bands, lowFreq, highFreq);
+}
 
-    // Calculate the FFT
-    m_fft->calculateFFT(m_output.data(), m_input.data());
+void SpectrumAnalyserThread::calculateSpectrum(qint64 sequence,
+                                                const QByteArray &buffer,
+                                                int inputFrequency,
+                                                int bytesPerFrame,
+                                                int channelCount,
+                                                int sampleFormat)
+{
+    Q_ASSERT(buffer.size() == m_calculator.frameLength() * bytesPerFrame);
 
-    // Analyze output to obtain amplitude and phase for each frequency
-    for (int i = 2; i <= m_numSamples / 2; ++i)
-    {
-        // Calculate frequency of this complex sample
-        m_spectrum[i].frequency = qreal(i * inputFrequency) / (m_numSamples);
-
-        const qreal real = m_output[i];
-        qreal imag = 0.0;
-        if (i > 0 && i < m_numSamples/2)
-        {
-            imag = m_output[m_numSamples / 2 + i];
-        }
-
-        const qreal magnitude = qSqrt(real * real + imag*imag);
-        qreal amplitude = SpectrumAnalyserMultiplier * qLn(magnitude);
-
-        // Bound amplitude to [0.0, 1.0]
-        m_spectrum[i].clipped = (amplitude > 1.0);
-        amplitude = qMax(qreal(0.0), amplitude);
-        amplitude = qMin(qreal(1.0), amplitude);
-        m_spectrum[i].amplitude = amplitude;
-    }
+    m_calculator.calculate(m_buffer->beginWrite(m_writer), buffer.constData(), inputFrequency, bytesPerFrame,
+                           channelCount, QAudioFormat::SampleFormat(sampleFormat));
+    m_buffer->endWrite(m_writer, sequence);
 
-    emit calculationComplete(m_spectrum);
+    emit calculationComplete(sequence);
 }
 
 //=============================================================================
@@ -100,14 +85,24 @@ void SpectrumAnalyserThread::calculateSpectrum(const QByteArray &buffer,
 
 SpectrumAnalyser::SpectrumAnalyser(QObject *parent)
     :   QObject(parent)
-    ,   m_thread(new SpectrumAnalyserThread(this))
-    ,   m_state(Idle)
+    ,   m_fftLengthPowerOfTwo(FFTLengthPowerOfTwo)
+    ,   m_stereoPacking(false)
+    ,   m_instantaneousFrequency(false)
+    ,   m_constantQBands(0)
+    ,   m_constantQLowFreq(0.0f)
+    ,   m_constantQHighFreq(0.0f)
+    ,   m_sampleRate(0)
+    ,   m_nextSequence(0)
+    ,   m_firstSequence(0)
+    ,   m_droppedFrames(0)
 {
-    connect(m_thread, &SpectrumAnalyserThread::calculationComplete,
-            this, &SpectrumAnalyser::calculationComplete);
+    setWorkerCount(qBound(1, QThread::idealThreadCount() / 2, MaxDefaultWorkerCount));
 }
 
-SpectrumAnalyser::~SpectrumAnalyser() = default;
+SpectrumAnalyser::~SpectrumAnalyser()
+{
+    deleteWorkers();
+}
 
 //-----------------------------------------------------------------------------
 // Public functions
@@ -116,56 +111,250 @@ SpectrumAnalyser::~SpectrumAnalyser() = default;
 void SpectrumAnalyser::calculate(const QByteArray &buffer,
                          const QAudioFormat &format)
 {
-    // QThread::currentThread is marked 'for internal use only', but
-    // we're only using it for debug output here, so it's probably OK :)
+    Q_ASSERT(format.sampleFormat() != QAudioFormat::Unknown);
+
+    if (format.sampleRate() != m_sampleRate)
+    {
+        m_sampleRate = format.sampleRate();
+        prepareConstantQ();
+    }
+
+    // The oldest queued frame makes room for the newest one
+    if (!isReady())
+    {
+        m_queue.dequeue();
+        ++m_droppedFrames;
+        emit droppedFramesChanged(m_droppedFrames);
+    }
+
+    m_queue.enqueue({buffer, format.sampleRate(), format.bytesPerFrame(),
+                     format.channelCount(), format.sampleFormat()});
+    dispatch();
+}
+
+void SpectrumAnalyser::setFFTLength(int powerOfTwo)
+{
+    m_fftLengthPowerOfTwo = powerOfTwo;
+
+    // Queued frames have the old length
+    m_queue.clear();
+
+    // The window of the new length is computed here, not in the worker threads
+    WindowTable::get(m_windowFunction, 1 << m_fftLengthPowerOfTwo);
+    prepareConstantQ();
+
+    // Queued behind the calculations already sent to the threads
+    for (SpectrumAnalyserThread *worker : std::as_const(m_workers))
+    {
+        const bool b = QMetaObject::invokeMethod(worker, "setFFTLength",
+                                  Qt::AutoConnection,
+                                  Q_ARG(int, powerOfTwo));
+        Q_ASSERT(b);
+        Q_UNUSED(b); // suppress warnings in release builds
+    }
+}
+
+void SpectrumAnalyser::setStereoPacking(bool enabled)
+{
+    m_stereoPacking = enabled;
+    for (SpectrumAnalyserThread *worker : std::as_const(m_workers))
+    {
+        const bool b = QMetaObject::invokeMethod(worker, "setStereoPacking",
+                                  Qt::AutoConnection,
+                                  Q_ARG(bool, enabled));
+        Q_ASSERT(b);
+        Q_UNUSED(b); // suppress warnings in release builds
+    }
+}
+
+void SpectrumAnalyser::setAmplitudeScale(const AmplitudeScale &scale)
+{
+    m_scale = scale;
+    for (SpectrumAnalyserThread *worker : std::as_const(m_workers))
+    {
+        const bool b = QMetaObject::invokeMethod(worker, "setAmplitudeScale",
+                                  Qt::AutoConnection,
+                                  Q_ARG(int, scale.mode),
+                                  Q_ARG(float, scale.floor),
+                                  Q_ARG(float, scale.ceiling));
+        Q_ASSERT(b);
+        Q_UNUSED(b); // suppress warnings in release builds
+    }
+}
+
+void SpectrumAnalyser::setWindowFunction(const WindowFunction &function)
+{
+    m_windowFunction = function;
+
+    // The table is computed here, the workers only fetch it from the cache
+    WindowTable::get(m_windowFunction, 1 << m_fftLengthPowerOfTwo);
 
-    if (isReady())
+    for (SpectrumAnalyserThread *worker : std::as_const(m_workers))
     {
-        Q_ASSERT(format.sampleFormat() == QAudioFormat::Int16);
+        const bool b = QMetaObject::invokeMethod(worker, "setWindowFunction",
+                                  Qt::AutoConnection,
+                                  Q_ARG(int, function.type),
+                                  Q_ARG(float, function.parameter));
+        Q_ASSERT(b);
+        Q_UNUSED(b); // suppress warnings in release builds
+    }
+}
+
+void SpectrumAnalyser::setInstantaneousFrequency(bool enabled)
+{
+    m_instantaneousFrequency = enabled;
 
-        const int bytesPerFrame = format.bytesPerFrame();
+    // Queued frames have the old length
+    m_queue.clear();
+
+    for (SpectrumAnalyserThread *worker : std::as_const(m_workers))
+    {
+        const bool b = QMetaObject::invokeMethod(worker, "setInstantaneousFrequency",
+                                  Qt::AutoConnection,
+                                  Q_ARG(bool, enabled));
+        Q_ASSERT(b);
+        Q_UNUSED(b); // suppress warnings in release builds
+    }
+}
 
-        m_state = Busy;
+void SpectrumAnalyser::setConstantQ(int bands, float lowFreq, float highFreq)
+{
+    m_constantQBands = qMax(bands, 0);
+    m_constantQLowFreq = lowFreq;
+    m_constantQHighFreq = highFreq;
+    prepareConstantQ();
 
-        // Invoke SpectrumAnalyserThread::calculateSpectrum using QMetaObject.  If
-        // m_thread is in a different thread from the current thread, the
-        // calculation will be done in the child thread.
-        // Once the calculation is finished, a calculationChanged signal will be
-        // emitted by m_thread.
-        const bool b = QMetaObject::invokeMethod(m_thread, "calculateSpectrum",
+    for (SpectrumAnalyserThread *worker : std::as_const(m_workers))
+    {
+        const bool b = QMetaObject::invokeMethod(worker, "setConstantQ",
                                   Qt::AutoConnection,
-                                  Q_ARG(QByteArray, buffer),
-                                  Q_ARG(int, format.sampleRate()),
-                                  Q_ARG(int, bytesPerFrame));
+                                  Q_ARG(int, m_constantQBands),
+                                  Q_ARG(float, lowFreq),
+                                  Q_ARG(float, highFreq));
         Q_ASSERT(b);
         Q_UNUSED(b); // suppress warnings in release builds
     }
 }
 
+int SpectrumAnalyser::frameLength() const
+{
+    return SpectrumCalculator::frameLength(m_fftLengthPowerOfTwo, m_instantaneousFrequency);
+}
+
 bool SpectrumAnalyser::isReady() const
 {
-    return (Idle == m_state);
+    return m_queue.count() < m_workers.count() * QueueDepthPerWorker;
+}
+
+bool SpectrumAnalyser::updateSpectrum()
+{
+    // Spectra of frames from before the cancellation are skipped
+    return m_buffer.update() && m_buffer.frontSequence() >= m_firstSequence;
 }
 
 void SpectrumAnalyser::cancelCalculation()
 {
-    if (Busy == m_state)
+    m_queue.clear();
+
+    // Results of frames sent before this point will be skipped
+    m_firstSequence = m_nextSequence;
+}
+
+void SpectrumAnalyser::setWorkerCount(int count)
+{
+    count = qMax(1, count);
+    if (count == m_workers.count())
     {
-        m_state = Cancelled;
+        return;
     }
-}
 
+    deleteWorkers();
+    cancelCalculation();
+    m_buffer.setWriterCount(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        SpectrumAnalyserThread *worker = new SpectrumAnalyserThread(m_fftLengthPowerOfTwo, &m_buffer, i);
+        worker->setStereoPacking(m_stereoPacking);
+        worker->setAmplitudeScale(m_scale.mode, m_scale.floor, m_scale.ceiling);
+        worker->setWindowFunction(m_windowFunction.type, m_windowFunction.parameter);
+        worker->setInstantaneousFrequency(m_instantaneousFrequency);
+        worker->setConstantQ(m_constantQBands, m_constantQLowFreq, m_constantQHighFreq);
+
+        QThread *thread = new QThread(this);
+        worker->moveToThread(thread);
+        connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+
+        // A result of a deleted worker may still wait in the event queue
+        const QPointer<SpectrumAnalyserThread> guard(worker);
+        connect(worker, &SpectrumAnalyserThread::calculationComplete, this,
+                [this, guard]() {
+            if (guard)
+            {
+                calculationComplete(guard.data());
+            }
+        });
+
+        thread->start();
+        m_threads.append(thread);
+        m_workers.append(worker);
+        m_idleWorkers.append(worker);
+    }
+}
 
 //-----------------------------------------------------------------------------
-// Private slots
+// Private functions
 //-----------------------------------------------------------------------------
 
-void SpectrumAnalyser::calculationComplete(const FrequencySpectrum &spectrum)
+void SpectrumAnalyser::calculationComplete(SpectrumAnalyserThread *worker)
+{
+    m_idleWorkers.append(worker);
+    dispatch();
+}
+
+void SpectrumAnalyser::prepareConstantQ()
+{
+    // The workers only fetch the kernel from the cache
+    if (m_constantQBands > 0 && m_sampleRate > 0)
+    {
+        ConstantQKernel::get(1 << m_fftLengthPowerOfTwo, m_sampleRate, m_constantQBands,
+                             m_constantQLowFreq, m_constantQHighFreq);
+    }
+}
+
+void SpectrumAnalyser::dispatch()
+{
+    while (!m_queue.isEmpty() && !m_idleWorkers.isEmpty())
+    {
+        const Frame frame = m_queue.dequeue();
+
+        // Invoke SpectrumAnalyserThread::calculateSpectrum using QMetaObject. The
+        // worker lives in its own thread, so the calculation is done there.
+        // Once the calculation is finished, a calculationComplete signal will be
+        // emitted by the worker.
+        const bool b = QMetaObject::invokeMethod(m_idleWorkers.takeLast(), "calculateSpectrum",
+                                  Qt::AutoConnection,
+                                  Q_ARG(qint64, m_nextSequence++),
+                                  Q_ARG(QByteArray, frame.buffer),
+                                  Q_ARG(int, frame.sampleRate),
+                                  Q_ARG(int, frame.bytesPerFrame),
+                                  Q_ARG(int, frame.channelCount),
+                                  Q_ARG(int, frame.sampleFormat));
+        Q_ASSERT(b);
+        Q_UNUSED(b); // suppress warnings in release builds
+    }
+}
+
+void SpectrumAnalyser::deleteWorkers()
 {
-    Q_ASSERT(Idle != m_state);
-    if (Busy == m_state)
+    // Workers are deleted once their threads have finished
+    for (QThread *thread : std::as_const(m_threads))
     {
-        emit spectrumChanged(spectrum);
+        thread->quit();
+        thread->wait();
+        delete thread;
     }
-    m_state = Idle;
+    m_threads.clear();
+    m_workers.clear();
+    m_idleWorkers.clear();
 }
@@ -4,84 +4,132 @@
 #include <QByteArray>
 #include <QObject>
 #include <QList>
+#include <QQueue>
 
 #include "frequencyspectrum.h"
-#include "3rdparty/fftreal/FFTRealFixLenParam.h"
+#include "spectrumbuffer.h"
+#include "spectrumcalculator.h"
 
 QT_FORWARD_DECLARE_CLASS(QAudioFormat)
 QT_FORWARD_DECLARE_CLASS(QThread)
 
-// Zmienna odpowiedzialna za wzmocnienie amplitudy
-const qreal SpectrumAnalyserMultiplier = 0.15;
-
-class FFTRealWrapper;
-
-class SpectrumAnalyserThreadPrivate;
-
 
 /*!
  * \brief Klasa SpectrumAnalyserThread
  *
- * Klasa odpowiedzialna za obliczanie FFT
+ * Pojedynczy wykonawca puli SpectrumAnalyser. Oblicza FFT w osobnym wątku, same obliczenia
+ * wykonuje jego własny SpectrumCalculator, więc wykonawcy nie dzielą buforów. Widmo jest
+ * liczone od razu do jego slotu w SpectrumBuffer.
  */
 class SpectrumAnalyserThread : public QObject
 {
     Q_OBJECT
 
 public:
-    SpectrumAnalyserThread(QObject *parent);
+    /*!
+     * \param[in] powerOfTwo - wykładnik potęgi 2 długości transformacji
+     * \param[in] buffer - bufor, do którego są publikowane widma
+     * \param[in] writer - numer slotu wykonawcy w buforze
+     */
+    SpectrumAnalyserThread(int powerOfTwo, SpectrumBuffer *buffer, int writer, QObject *parent = nullptr);
     ~SpectrumAnalyserThread();
 
 public slots:
 
     /*!
-     * \brief Wywołanie obliczenia okna transformacji
+     * \brief Zmiana funkcji okna
+     *
+     * Tablica okna jest już w pamięci podręcznej, więc zmiana nie wstrzymuje obliczeń.
+     * \param[in] type - WindowFunction::Type
+     * \param[in] parameter - parametr okna, 0 dla domyślnego
+     */
+    void setWindowFunction(int type, float parameter);
+
+    /*!
+     * \brief Zmiana długości transformacji
+     *
+     * Tworzy FFT o nowej długości i dopasowuje do niej bufory i okno.
+     * \param[in] powerOfTwo - wykładnik potęgi 2 długości transformacji
+     */
+    void setFFTLength(int powerOfTwo);
+
+    /*!
+     * \brief Włączenie liczenia obu kanałów jedną transformatą
+     *
+     * Kanały stereo są pakowane w jedną transformatę o podwójnej długości
+     * i rozdzielane z symetrii sprzężonej (FFTRealStereoWrapper).
+     * \param[in] enabled - czy pakować kanały
+     */
+    void setStereoPacking(bool enabled);
+
+    /*!
+     * \brief Zmiana skali amplitudy
+     *
+     * \param[in] mode - AmplitudeScale::Mode
+     * \param[in] floor - próg dolny skali decybelowej w dB
+     * \param[in] ceiling - próg górny skali decybelowej w dB
+     */
+    void setAmplitudeScale(int mode, float floor, float ceiling);
+
+    /*!
+     * \brief Włączenie liczenia częstotliwości chwilowej
+     *
+     * \param[in] enabled - czy liczyć częstotliwość chwilową
+     */
+    void setInstantaneousFrequency(bool enabled);
+
+    /*!
+     * \brief Włączenie transformaty stałego Q
+     *
+     * \param[in] bands - liczba pasm, 0 wyłącza transformatę
+     * \param[in] lowFreq - lewa krawędź pierwszego pasma
+     * \param[in] highFreq - prawa krawędź ostatniego pasma
      */
-    void setWindowFunction();
+    void setConstantQ(int bands, float lowFreq, float highFreq);
 
     /*!
      * \brief Przygotowywanie danych do obliczeń i wywołanie FFT
      *
+     * Dla sygnału stereo liczone są widma obu kanałów oraz wyprowadzone z nich widma mid/side.
+     * \param[in] sequence - numer ramki, zwracany razem z wynikiem
      * \param[in] buffer - bufon danych do transforamcji
      * \param[in] inputFrequency - częstotliwość wejściowa do transforamcji
      * \param[in] bytesPerSample - ilość byte'ów na próbkę do transformacji
+     * \param[in] channelCount - ilość kanałów w ramce
+     * \param[in] sampleFormat - format próbek, QAudioFormat::SampleFormat
      */
-    void calculateSpectrum(const QByteArray &buffer,
+    void calculateSpectrum(qint64 sequence,
+                           const QByteArray &buffer,
                            int inputFrequency,
-                           int bytesPerSample);
+                           int bytesPerSample,
+                           int channelCount,
+                           int sampleFormat);
 
 signals:
     /*!
      * \brief Sygnalizacja, że obliczenie FFT zostały zakończone
      *
-     * \param[in] spectrum - obliczone spektrum
+     * Samo widmo jest już opublikowane w SpectrumBuffer.
+     * \param[in] sequence - numer ramki
      */
-    void calculationComplete(const FrequencySpectrum &spectrum);
+    void calculationComplete(qint64 sequence);
 
 private:
-    /*!
-     * \brief obliczenie okna transformacji
-     */
-    void calculateWindow();
-
-private:
-
-    FFTRealWrapper*                             m_fft;
-
-    const int                                   m_numSamples;
 
-    typedef FFTRealFixLenParam::DataType        DataType;
-    QList<DataType>                             m_window;
-    QList<DataType>                             m_input;
-    QList<DataType>                             m_output;
-    FrequencySpectrum                           m_spectrum;
-    QThread*                                    m_thread;
+    SpectrumCalculator                          m_calculator;
+    SpectrumBuffer*                             m_buffer;
+    int                                         m_writer;
 };
 
 /*!
  * \brief Klasa SpectrumAnalyser
  *
- * Klasa odpowiedzialna za obliczanie FFT.
+ * Klasa odpowiedzialna za obliczanie FFT. Ramki trafiają do ograniczonej kolejki, z której
+ * pobiera je pula wykonawców SpectrumAnalyserThread. Wykonawcy publikują widma w SpectrumBuffer,
+ * z którego wątek GUI bierze najnowsze przez updateSpectrum, bez kopiowania i bez sygnałów
+ * niosących widmo. Starsze widmo nigdy nie zastępuje nowszego, niezależnie od tego, który
+ * wykonawca skończył pierwszy. Gdy kolejka jest pełna, najstarsza czekająca ramka jest
+ * odrzucana i liczona w droppedFrames.
  */
 class SpectrumAnalyser : public QObject
 {
@@ -96,52 +144,191 @@ public:
     /*!
      * \brief Oblicz spektrum częstotliwości
      *
+     * Ramka jest kolejkowana, wynik można odebrać przez updateSpectrum.
      * \param[in] buffer - bufor danych audio
      * \param[in] format - format danych audio
      */
     void calculate(const QByteArray &buffer, const QAudioFormat &format);
 
     /*!
-     * \brief Sprawdza czy można dokonać kolejnej kalkulacji
+     * \brief Sprawdza czy kolejna ramka zmieści się w kolejce bez odrzucania innej
      *
      * \return Czy można dokonać kolejnych kalkulacji
      */
     bool isReady() const;
 
     /*!
-     * \brief Anuluj aktualną kalkulację
+     * \brief Pobiera najnowsze opublikowane spektrum
+     *
+     * \return Czy spectrum() się zmieniło
+     */
+    bool updateSpectrum();
+
+    /*!
+     * \brief Spektrum pobrane przez updateSpectrum
+     *
+     * Pozostaje ważne i niezmienione do następnego wywołania updateSpectrum lub setWorkerCount.
+     */
+    const FrequencySpectrum &spectrum() const { return m_buffer.front(); }
+
+    /*!
+     * \brief Anuluj kolejkowane i trwające kalkulacje
+     *
+     * Ich wyniki nie zostaną pobrane, nie są też liczone jako odrzucone.
      */
     void cancelCalculation();
 
-signals:
+    /*!
+     * \brief Zmiana liczby wykonawców
+     *
+     * Anuluje trwające kalkulacje.
+     * \param[in] count - liczba wątków liczących FFT, co najmniej 1
+     */
+    void setWorkerCount(int count);
+
+    /*!
+     * \brief Zwraca liczbę wykonawców
+     */
+    int workerCount() const { return m_workers.count(); }
 
     /*!
-     * \brief Spektrum uległo zmianie
+     * \brief Zwraca liczbę ramek odrzuconych z powodu przepełnienia kolejki
+     */
+    qint64 droppedFrames() const { return m_droppedFrames; }
+
+    /*!
+     * \brief Zmiana długości transformacji
      *
-     * \param[in] spectrum - nowe spektrum
+     * Kolejne bufory przekazane do calculate muszą mieć nową długość.
+     * \param[in] powerOfTwo - wykładnik potęgi 2 długości transformacji
      */
-    void spectrumChanged(const FrequencySpectrum &spectrum);
+    void setFFTLength(int powerOfTwo);
 
-private slots:
+    /*!
+     * \brief Włączenie liczenia obu kanałów jedną transformatą
+     *
+     * \param[in] enabled - czy pakować kanały
+     */
+    void setStereoPacking(bool enabled);
 
     /*!
-     * \brief Kalkulacja została zakończona
+     * \brief Zmiana skali amplitudy
      *
-     * \param[in] spectrum - obliczone spektrum
+     * Dotyczy ramek wysłanych po wywołaniu.
+     * \param[in] scale - skala logarytmiczna lub decybelowa z progami
      */
-    void calculationComplete(const FrequencySpectrum &spectrum);
+    void setAmplitudeScale(const AmplitudeScale &scale);
 
-private:
+    /*!
+     * \brief Zmiana funkcji okna
+     *
+     * Tablica okna jest liczona tutaj, w wątku wywołującym, a wykonawcy tylko podmieniają
+     * wskaźnik na tablicę. Dotyczy ramek wysłanych po wywołaniu.
+     * \param[in] function - rodzaj okna i jego parametr
+     */
+    void setWindowFunction(const WindowFunction &function);
 
-    SpectrumAnalyserThread*    m_thread;
+    /*!
+     * \brief Aktualna funkcja okna
+     */
+    WindowFunction windowFunction() const { return m_windowFunction; }
 
-    enum State {
-        Idle,
-        Busy,
-        Cancelled
+    /*!
+     * \brief Włączenie liczenia częstotliwości chwilowej
+     *
+     * Kolejne bufory przekazane do calculate muszą mieć długość frameLength().
+     * \param[in] enabled - czy liczyć częstotliwość chwilową
+     */
+    void setInstantaneousFrequency(bool enabled);
+
+    /*!
+     * \brief Liczba ramek audio w buforze przekazywanym do calculate
+     *
+     * Długość transformacji, a z częstotliwością chwilową dodatkowo krok przed oknem.
+     */
+    int frameLength() const;
+
+    /*!
+     * \brief Włączenie transformaty stałego Q
+     *
+     * Widma zawierają wtedy pasma o środkach rozłożonych logarytmicznie zamiast prążków FFT.
+     * Jądro transformaty jest liczone tutaj, w wątku wywołującym, dla częstotliwości próbkowania
+     * ostatniej ramki. Dotyczy ramek wysłanych po wywołaniu.
+     * \param[in] bands - liczba pasm, 0 wyłącza transformatę
+     * \param[in] lowFreq - lewa krawędź pierwszego pasma
+     * \param[in] highFreq - prawa krawędź ostatniego pasma
+     */
+    void setConstantQ(int bands, float lowFreq, float highFreq);
+
+    /*!
+     * \brief Liczba pasm transformaty stałego Q, 0 jeśli jest wyłączona
+     */
+    int constantQBands() const { return m_constantQBands; }
+
+signals:
+
+    /*!
+     * \brief Ramka została odrzucona
+     *
+     * \param[in] dropped - łączna liczba odrzuconych ramek
+     */
+    void droppedFramesChanged(qint64 dropped);
+
+private:
+
+    /*!
+     * \brief Ramka czekająca w kolejce
+     */
+    struct Frame
+    {
+        QByteArray  buffer;
+        int         sampleRate;
+        int         bytesPerFrame;
+        int         channelCount;
+        int         sampleFormat;
     };
 
-    State              m_state;
+    /*!
+     * \brief Kalkulacja została zakończona
+     *
+     * \param[in] worker - wykonawca, który jest znów wolny
+     */
+    void calculationComplete(SpectrumAnalyserThread *worker);
+
+    /*!
+     * \brief Liczy jądro stałego Q, zanim będą go potrzebować wykonawcy
+     */
+    void prepareConstantQ();
+
+    /*!
+     * \brief Przekazuje ramki z kolejki wolnym wykonawcom
+     */
+    void dispatch();
+
+    /*!
+     * \brief Zatrzymuje wątki i usuwa wykonawców
+     */
+    void deleteWorkers();
+
+    QList<QThread*>                         m_threads;
+    QList<SpectrumAnalyserThread*>          m_workers;
+    QList<SpectrumAnalyserThread*>          m_idleWorkers;
+    QQueue<Frame>                           m_queue;
+    SpectrumBuffer                          m_buffer;
+
+    int                 m_fftLengthPowerOfTwo;
+    bool                m_stereoPacking;
+    bool                m_instantaneousFrequency;
+    AmplitudeScale      m_scale;
+    WindowFunction      m_windowFunction;
+    int                 m_constantQBands;
+    float               m_constantQLowFreq;
+    float               m_constantQHighFreq;
+    int                 m_sampleRate;
+
+    qint64              m_nextSequence;
+    qint64              m_firstSequence;
+    qint64              m_droppedFrames;
 };
 
 #endif // SPECTRUMANALYSER_H
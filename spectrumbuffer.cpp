@@ -0,0 +1,78 @@
+#include "spectrumbuffer.h"
+
+SpectrumBuffer::SpectrumBuffer(int writerCount)
+    :   m_middle(0)
+    ,   m_front(0)
+{
+    setWriterCount(writerCount);
+}
+
+SpectrumBuffer::~SpectrumBuffer() = default;
+
+void SpectrumBuffer::setWriterCount(int writerCount)
+{
+    writerCount = qMax(1, writerCount);
+
+    // Front and middle, and one back slot per writer
+    m_slots = QList<FrequencySpectrum>(writerCount + 2);
+    m_sequences = QList<qint64>(writerCount + 2, -1);
+    m_back.resize(writerCount);
+
+    m_front = 0;
+    m_middle.store(1, std::memory_order_relaxed);
+    for (int writer = 0; writer < writerCount; ++writer)
+    {
+        m_back[writer] = writer + 2;
+    }
+}
+
+FrequencySpectrum &SpectrumBuffer::beginWrite(int writer)
+{
+    return m_slots[m_back[writer]];
+}
+
+void SpectrumBuffer::endWrite(int writer, qint64 sequence)
+{
+    const int back = m_back[writer];
+    m_sequences[back] = sequence;
+
+    // Release publishes the spectrum, acquire takes over the previous middle slot
+    m_back[writer] = m_middle.exchange(back | DirtyBit, std::memory_order_acq_rel) & ~DirtyBit;
+}
+
+bool SpectrumBuffer::update()
+{
+    if (!(m_middle.load(std::memory_order_relaxed) & DirtyBit))
+    {
+        return false;
+    }
+
+    // Once exchanged, the front slot may be taken and refilled by a writer
+    const int front = m_front;
+    const qint64 frontSequence = m_sequences[front];
+
+    int given = front;
+    qint64 givenSequence = frontSequence;
+    int taken = m_middle.exchange(front, std::memory_order_acq_rel) & ~DirtyBit;
+
+    // A slower writer published an older spectrum: put it back and take the middle again.
+    // That returns the slot given before, unless a writer has published in the meantime,
+    // which is then checked in turn. A slot comes back unchanged only with its sequence.
+    while (m_sequences[taken] <= frontSequence)
+    {
+        const qint64 takenSequence = m_sequences[taken];
+        const int returned = m_middle.exchange(taken, std::memory_order_acq_rel) & ~DirtyBit;
+        const bool unchanged = returned == given && m_sequences[returned] == givenSequence;
+
+        given = taken;
+        givenSequence = takenSequence;
+        taken = returned;
+        if (unchanged)
+        {
+            break;
+        }
+    }
+
+    m_front = taken;
+    return m_sequences[taken] != frontSequence;
+}
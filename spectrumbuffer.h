@@ -0,0 +1,87 @@
+#ifndef SPECTRUMBUFFER_H
+#define SPECTRUMBUFFER_H
+
+#include "frequencyspectrum.h"
+
+#include <QList>
+
+#include <atomic>
+
+/*!
+ * \brief SpectrumBuffer Class
+ *
+ * Lock-free handoff of the newest spectrum from the analysis workers to the GUI thread.
+ * It is a triple buffer with one back slot per writer: every writer fills its own slot
+ * and swaps it with the shared middle slot, the reader swaps its front slot with the
+ * middle one when that holds a new spectrum. Spectra are written in place, so once the
+ * slots have their size nothing is allocated or copied per frame.
+ *
+ * Writers may finish out of order, so every published spectrum carries its sequence
+ * number and the reader skips a spectrum older than the one it holds, giving it back
+ * to the middle slot. Only if a writer has taken the front slot in the meantime, so
+ * that the old front spectrum is being overwritten, may the reader be left with an
+ * older spectrum.
+ */
+class SpectrumBuffer
+{
+public:
+    explicit SpectrumBuffer(int writerCount = 1);
+    ~SpectrumBuffer();
+
+    /*!
+     * \brief Sets the number of writers and drops all spectra
+     *
+     * Must not be called while a writer is active. References to the front spectrum
+     * are invalidated.
+     * \param[in] writerCount - number of writers, each gets its own back slot
+     */
+    void setWriterCount(int writerCount);
+
+    /*!
+     * \brief Slot to fill with the next spectrum of a writer (writer side)
+     *
+     * \param[in] writer - index of the writer
+     * \param[out] FrequencySpectrum - back slot owned by the writer until endWrite
+     */
+    FrequencySpectrum &beginWrite(int writer);
+
+    /*!
+     * \brief Publishes the back slot of a writer (writer side)
+     *
+     * \param[in] writer - index of the writer
+     * \param[in] sequence - sequence number of the spectrum
+     */
+    void endWrite(int writer, qint64 sequence);
+
+    /*!
+     * \brief Takes the newest published spectrum (reader side)
+     *
+     * \param[out] bool - true if the front spectrum has changed
+     */
+    bool update();
+
+    /*!
+     * \brief Newest spectrum taken by update (reader side)
+     *
+     * Stays valid and unchanged until the next update.
+     */
+    const FrequencySpectrum &front() const { return m_slots[m_front]; }
+
+    /*!
+     * \brief Sequence number of the front spectrum, -1 before the first one (reader side)
+     */
+    qint64 frontSequence() const { return m_sequences[m_front]; }
+
+private:
+
+    // Set in the middle index while it holds a spectrum not taken by the reader
+    static const int DirtyBit = 1 << 30;
+
+    QList<FrequencySpectrum>    m_slots;
+    QList<qint64>               m_sequences;
+    QList<int>                  m_back;
+    std::atomic<int>            m_middle;
+    int                         m_front;
+};
+
+#endif // SPECTRUMBUFFER_H
@@ -0,0 +1,269 @@
+#include "spectrumcalculator.h"
+#include "sampleconversion.h"
+#include "3rdparty/fftreal/fftreal_wrapper.h"
+
+SpectrumCalculator::SpectrumCalculator(int powerOfTwo)
+    :   m_fft(nullptr)
+    ,   m_stereoFft(nullptr)
+    ,   m_numSamples(0)
+    ,   m_phaseHop(0)
+    ,   m_scaleSlope(0.0f)
+    ,   m_scaleOffset(0.0f)
+    ,   m_constantQBands(0)
+    ,   m_constantQLowFreq(0.0f)
+    ,   m_constantQHighFreq(0.0f)
+    ,   m_constantQSlope(0.0f)
+    ,   m_constantQOffset(0.0f)
+{
+    setFFTLength(powerOfTwo);
+}
+
+SpectrumCalculator::~SpectrumCalculator()
+{
+    delete m_fft;
+    delete m_stereoFft;
+}
+
+void SpectrumCalculator::setFFTLength(int powerOfTwo)
+{
+    delete m_fft;
+    m_fft = new FFTRealWrapper(powerOfTwo);
+
+    m_numSamples = m_fft->length();
+    if (m_stereoFft)
+    {
+        delete m_stereoFft;
+        m_stereoFft = new FFTRealStereoWrapper(powerOfTwo);
+        m_interleaved.fill(0.0, 2 * m_numSamples);
+    }
+    m_input.fill(0.0, m_numSamples);
+    m_output.fill(0.0, m_numSamples);
+    m_inputRight.fill(0.0, m_numSamples);
+    m_outputRight.fill(0.0, m_numSamples);
+    m_outputMixed.fill(0.0, m_numSamples);
+    m_previousPhases.fill(0.0, (m_numSamples / 2 + 1) * FrequencySpectrum::ChannelCount);
+    if (m_phaseHop > 0)
+    {
+        m_phaseHop = m_numSamples / InstantaneousFrequencyHopDivisor;
+    }
+    m_spectrum = FrequencySpectrum(m_numSamples / 2 + 1, m_spectrum.channelCount());
+    setWindowFunction(m_windowFunction);
+    setConstantQ(m_constantQBands, m_constantQLowFreq, m_constantQHighFreq);
+}
+
+void SpectrumCalculator::setStereoPacking(bool enabled)
+{
+    delete m_stereoFft;
+    m_stereoFft = nullptr;
+    m_interleaved.clear();
+
+    if (enabled)
+    {
+        m_stereoFft = new FFTRealStereoWrapper(m_fft->powerOfTwo());
+        m_interleaved.fill(0.0, 2 * m_numSamples);
+    }
+}
+
+void SpectrumCalculator::setInstantaneousFrequency(bool enabled)
+{
+    m_phaseHop = enabled ? m_numSamples / InstantaneousFrequencyHopDivisor : 0;
+}
+
+int SpectrumCalculator::frameLength(int powerOfTwo, bool instantaneousFrequency)
+{
+    const int length = 1 << powerOfTwo;
+    return instantaneousFrequency ? length + length / InstantaneousFrequencyHopDivisor : length;
+}
+
+void SpectrumCalculator::setAmplitudeScale(const AmplitudeScale &scale)
+{
+    // The coefficients depend on the transform length and the window gain, so they are computed once here
+    m_scale = scale;
+    amplitudeScaleCoefficients(m_scale, m_numSamples, m_window->coherentGain(),
+                               SpectrumAnalyserMultiplier, &m_scaleSlope, &m_scaleOffset);
+
+    // Constant-Q kernels give amplitudes like an FFT with the Hann window
+    amplitudeScaleCoefficients(m_scale, m_numSamples, 0.5f,
+                               SpectrumAnalyserMultiplier, &m_constantQSlope, &m_constantQOffset);
+}
+
+void SpectrumCalculator::setWindowFunction(const WindowFunction &function)
+{
+    m_windowFunction = function;
+    m_window = WindowTable::get(m_windowFunction, m_numSamples);
+    setAmplitudeScale(m_scale);
+}
+
+void SpectrumCalculator::setConstantQ(int bands, float lowFreq, float highFreq)
+{
+    m_constantQBands = qMax(bands, 0);
+    m_constantQLowFreq = lowFreq;
+    m_constantQHighFreq = highFreq;
+
+    // The kernel also depends on the sample rate, so it is fetched when calculating
+    m_constantQ.reset();
+    if (m_constantQBands > 0)
+    {
+        m_rectangular.fill(1.0, m_numSamples);
+        m_bandReal.fill(0.0f, m_constantQBands);
+        m_bandImag.fill(0.0f, m_constantQBands);
+    }
+    else
+    {
+        m_rectangular.clear();
+        m_bandReal.clear();
+        m_bandImag.clear();
+    }
+}
+
+const FrequencySpectrum &SpectrumCalculator::calculate(const char *data,
+                                                      int inputFrequency,
+                                                      int bytesPerFrame,
+                                                      int channelCount,
+                                                      QAudioFormat::SampleFormat format)
+{
+    calculate(m_spectrum, data, inputFrequency, bytesPerFrame, channelCount, format);
+    return m_spectrum;
+}
+
+void SpectrumCalculator::calculate(FrequencySpectrum &spectrum,
+                                   const char *data,
+                                   int inputFrequency,
+                                   int bytesPerFrame,
+                                   int channelCount,
+                                   QAudioFormat::SampleFormat format)
+{
+    const bool stereo = channelCount >= 2;
+    if (m_constantQBands > 0)
+    {
+        // No instantaneous frequency, so the earlier data step is skipped
+        calculateConstantQ(spectrum, data + qint64(m_phaseHop) * bytesPerFrame, inputFrequency,
+                           bytesPerFrame, stereo, format);
+        return;
+    }
+
+    const int numChannels = stereo ? int(FrequencySpectrum::ChannelCount) : 1;
+    if (spectrum.channelCount() != numChannels || spectrum.size() != m_numSamples / 2 + 1)
+    {
+        spectrum = FrequencySpectrum(m_numSamples / 2 + 1, numChannels);
+    }
+    spectrum.setSampleRate(inputFrequency);
+
+    spectrum.setInstantaneousFrequenciesEnabled(m_phaseHop > 0);
+
+    const int numBins = m_numSamples / 2 + 1;
+    if (m_phaseHop > 0)
+    {
+        // The data starts with the window one hop earlier, only its phases are needed
+        transform(data, bytesPerFrame, stereo, format, m_window->data());
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            spectrumPhases(channelOutput(FrequencySpectrum::Channel(channel)), m_numSamples,
+                           m_previousPhases.data() + channel * numBins);
+        }
+        data += qint64(m_phaseHop) * bytesPerFrame;
+    }
+
+    transform(data, bytesPerFrame, stereo, format, m_window->data());
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const FrequencySpectrum::Channel spectrumChannel = FrequencySpectrum::Channel(channel);
+        fillChannel(spectrum, spectrumChannel, channelOutput(spectrumChannel));
+        if (m_phaseHop > 0)
+        {
+            instantaneousFrequencies(spectrum.phases(spectrumChannel), m_previousPhases.constData() + channel * numBins,
+                                     numBins, m_numSamples, m_phaseHop, float(inputFrequency),
+                                     spectrum.instantaneousFrequencies(spectrumChannel));
+        }
+    }
+}
+
+void SpectrumCalculator::calculateConstantQ(FrequencySpectrum &spectrum, const char *data, int inputFrequency,
+                                            int bytesPerFrame, bool stereo, QAudioFormat::SampleFormat format)
+{
+    if (!m_constantQ || m_constantQ->sampleRate() != inputFrequency)
+    {
+        m_constantQ = ConstantQKernel::get(m_numSamples, inputFrequency, m_constantQBands,
+                                           m_constantQLowFreq, m_constantQHighFreq);
+    }
+
+    const int numChannels = stereo ? int(FrequencySpectrum::ChannelCount) : 1;
+    if (spectrum.channelCount() != numChannels || spectrum.size() != m_constantQBands)
+    {
+        spectrum = FrequencySpectrum(m_constantQBands, numChannels);
+    }
+    spectrum.setConstantQAxis(m_constantQ->frequencies(), inputFrequency);
+    spectrum.setInstantaneousFrequenciesEnabled(false);
+
+    // The band kernels carry their own window
+    transform(data, bytesPerFrame, stereo, format, m_rectangular.constData());
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const FrequencySpectrum::Channel spectrumChannel = FrequencySpectrum::Channel(channel);
+        m_constantQ->apply(channelOutput(spectrumChannel), m_bandReal.data(), m_bandImag.data());
+        bandAmplitudes(m_bandReal.constData(), m_bandImag.constData(), m_constantQBands,
+                       m_constantQSlope, m_constantQOffset,
+                       spectrum.amplitudes(spectrumChannel), spectrum.clipMask(spectrumChannel));
+        bandPhases(m_bandReal.constData(), m_bandImag.constData(), m_constantQBands,
+                   spectrum.phases(spectrumChannel));
+    }
+}
+
+void SpectrumCalculator::transform(const char *data, int bytesPerFrame, bool stereo,
+                                   QAudioFormat::SampleFormat format, const float *window)
+{
+    if (stereo && m_stereoFft && 2 * bytesPerSample(format) == bytesPerFrame)
+    {
+        // Both channels in one transform, kept interleaved
+        windowInterleaved(format, data, m_numSamples, window, m_interleaved.data());
+        m_stereoFft->calculateFFT(m_output.data(), m_outputRight.data(), m_interleaved.constData());
+    }
+    else
+    {
+        // Split the channels, scale down to range [-1.0, 1.0] and apply the window
+        deinterleave(format, data, m_numSamples, bytesPerFrame, window,
+                     m_input.data(), stereo ? m_inputRight.data() : nullptr);
+
+        // Calculate the FFT
+        m_fft->calculateFFT(m_output.data(), m_input.data());
+        if (stereo)
+        {
+            m_fft->calculateFFT(m_outputRight.data(), m_inputRight.data());
+        }
+    }
+}
+
+const SpectrumCalculator::DataType *SpectrumCalculator::channelOutput(FrequencySpectrum::Channel channel)
+{
+    switch (channel)
+    {
+    case FrequencySpectrum::Right:
+        return m_outputRight.constData();
+    case FrequencySpectrum::Mid:
+        // The transform is linear, so mid and side come straight from the complex spectra
+        for (int i = 0; i < m_numSamples; ++i)
+        {
+            m_outputMixed[i] = 0.5f * (m_output[i] + m_outputRight[i]);
+        }
+        return m_outputMixed.constData();
+    case FrequencySpectrum::Side:
+        for (int i = 0; i < m_numSamples; ++i)
+        {
+            m_outputMixed[i] = 0.5f * (m_output[i] - m_outputRight[i]);
+        }
+        return m_outputMixed.constData();
+    case FrequencySpectrum::Left:
+    default:
+        return m_output.constData();
+    }
+}
+
+void SpectrumCalculator::fillChannel(FrequencySpectrum &spectrum,
+                                     FrequencySpectrum::Channel channel,
+                                     const DataType *output)
+{
+    // Amplitudes from the 2nd bin on, the frequency axis is shared
+    powerToAmplitudes(output, m_numSamples, m_scaleSlope, m_scaleOffset, 2,
+                      spectrum.amplitudes(channel), spectrum.clipMask(channel));
+    spectrumPhases(output, m_numSamples, spectrum.phases(channel));
+}
@@ -0,0 +1,225 @@
+#ifndef SPECTRUMCALCULATOR_H
+#define SPECTRUMCALCULATOR_H
+
+#include <QAudioFormat>
+#include <QList>
+
+#include "constantq.h"
+#include "frequencyspectrum.h"
+#include "spectrumkernels.h"
+#include "windowfunction.h"
+#include "3rdparty/fftreal/FFTRealFixLenParam.h"
+
+class FFTRealWrapper;
+class FFTRealStereoWrapper;
+
+// Zmienna odpowiedzialna za wzmocnienie amplitudy
+const qreal SpectrumAnalyserMultiplier = 0.15;
+
+// Distance of the transforms for the instantaneous frequency, as a fraction of the transform length
+const int InstantaneousFrequencyHopDivisor = 4;
+
+/*!
+ * \brief Klasa SpectrumCalculator
+ *
+ * Obliczenia widma dla jednego okna ramek audio: konwersja próbek, okno, FFT oraz amplitudy
+ * wszystkich kanałów. Nie jest związana z żadnym wątkiem, dzięki czemu te same obliczenia
+ * wykonuje SpectrumAnalyserThread dla podglądu na żywo i analiza plików na wielu rdzeniach
+ * (każdy wątek posiada własny obiekt).
+ */
+class SpectrumCalculator
+{
+public:
+    explicit SpectrumCalculator(int powerOfTwo);
+    ~SpectrumCalculator();
+
+    /*!
+     * \brief Długość transformacji w próbkach
+     */
+    int length() const { return m_numSamples; }
+
+    /*!
+     * \brief Liczba ramek audio potrzebnych do obliczenia widma
+     *
+     * Z częstotliwością chwilową dane zaczynają się o krok wcześniej niż okno transformacji.
+     */
+    int frameLength() const { return m_numSamples + m_phaseHop; }
+
+    /*!
+     * \brief Liczba ramek audio potrzebnych do obliczenia widma
+     *
+     * \param[in] powerOfTwo - wykładnik potęgi 2 długości transformacji
+     * \param[in] instantaneousFrequency - czy liczona jest częstotliwość chwilowa
+     */
+    static int frameLength(int powerOfTwo, bool instantaneousFrequency);
+
+    /*!
+     * \brief Zmiana długości transformacji
+     *
+     * \param[in] powerOfTwo - wykładnik potęgi 2 długości transformacji
+     */
+    void setFFTLength(int powerOfTwo);
+
+    /*!
+     * \brief Włączenie liczenia obu kanałów jedną transformatą
+     *
+     * \param[in] enabled - czy pakować kanały
+     */
+    void setStereoPacking(bool enabled);
+
+    /*!
+     * \brief Włączenie liczenia częstotliwości chwilowej
+     *
+     * Każde widmo jest liczone razem z transformatą okna o N/4 próbek wcześniejszego, a z różnicy
+     * faz obu transformat (jak w wokoderze fazowym) wyznaczana jest częstotliwość każdego prążka
+     * z dokładnością lepszą niż odstęp prążków. Podwaja to liczbę transformat.
+     * \param[in] enabled - czy liczyć częstotliwość chwilową
+     */
+    void setInstantaneousFrequency(bool enabled);
+
+    /*!
+     * \brief Zmiana skali amplitudy
+     *
+     * \param[in] scale - skala logarytmiczna lub decybelowa z progami
+     */
+    void setAmplitudeScale(const AmplitudeScale &scale);
+
+    /*!
+     * \brief Zmiana funkcji okna
+     *
+     * Tablica okna jest brana ze wspólnej pamięci podręcznej, liczona tylko przy pierwszym użyciu.
+     * \param[in] function - rodzaj okna i jego parametr
+     */
+    void setWindowFunction(const WindowFunction &function);
+
+    /*!
+     * \brief Włączenie transformaty stałego Q
+     *
+     * Zamiast prążków FFT widmo zawiera pasma o środkach rozłożonych logarytmicznie, każde mierzone
+     * własnym jądrem widmowym (Brown i Puckette) jako rzadki iloczyn z FFT ramki bez okna. Jądra
+     * pasm mają własne okno Hanna, więc wybrana funkcja okna nie jest wtedy używana, a częstotliwość
+     * chwilowa nie jest liczona.
+     * \param[in] bands - liczba pasm, 0 wyłącza transformatę
+     * \param[in] lowFreq - lewa krawędź pierwszego pasma
+     * \param[in] highFreq - prawa krawędź ostatniego pasma
+     */
+    void setConstantQ(int bands, float lowFreq, float highFreq);
+
+    /*!
+     * \brief Obliczenie widma
+     *
+     * Dane są czytane bezpośrednio spod wskaźnika, bez kopiowania.
+     * Dla sygnału stereo liczone są widma obu kanałów oraz wyprowadzone z nich widma mid/side.
+     * \param[in] data - frameLength() ramek audio
+     * \param[in] inputFrequency - częstotliwość próbkowania
+     * \param[in] bytesPerFrame - ilość byte'ów na ramkę
+     * \param[in] channelCount - ilość kanałów w ramce
+     * \param[in] sampleFormat - format próbek
+     * \param[out] FrequencySpectrum - obliczone spektrum, ważne do następnego wywołania
+     */
+    const FrequencySpectrum &calculate(const char *data,
+                                       int inputFrequency,
+                                       int bytesPerFrame,
+                                       int channelCount,
+                                       QAudioFormat::SampleFormat sampleFormat);
+
+    /*!
+     * \brief Obliczenie widma do podanego obiektu
+     *
+     * Spektrum jest wypełniane w miejscu, nowa pamięć jest przydzielana tylko gdy zmienia się
+     * jego rozmiar lub liczba kanałów.
+     * \param[out] spectrum - obliczone spektrum
+     * \param[in] data - frameLength() ramek audio
+     * \param[in] inputFrequency - częstotliwość próbkowania
+     * \param[in] bytesPerFrame - ilość byte'ów na ramkę
+     * \param[in] channelCount - ilość kanałów w ramce
+     * \param[in] sampleFormat - format próbek
+     */
+    void calculate(FrequencySpectrum &spectrum,
+                   const char *data,
+                   int inputFrequency,
+                   int bytesPerFrame,
+                   int channelCount,
+                   QAudioFormat::SampleFormat sampleFormat);
+
+private:
+    typedef FFTRealFixLenParam::DataType        DataType;
+
+    /*!
+     * \brief Wypełnienie kanału spektrum na podstawie wyniku FFT
+     *
+     * Liczy amplitudy, maskę przesterowania i fazy prążków.
+     * \param[out] spectrum - wypełniane spektrum
+     * \param[in] channel - wypełniany kanał
+     * \param[in] output - wynik FFT w układzie FFTReal
+     */
+    void fillChannel(FrequencySpectrum &spectrum, FrequencySpectrum::Channel channel,
+                     const DataType *output);
+
+    /*!
+     * \brief Obliczenie widma stałego Q
+     *
+     * \param[out] spectrum - obliczone spektrum
+     * \param[in] data - length() ramek audio
+     * \param[in] inputFrequency - częstotliwość próbkowania
+     * \param[in] bytesPerFrame - ilość byte'ów na ramkę
+     * \param[in] stereo - czy liczyć prawy kanał oraz mid/side
+     * \param[in] sampleFormat - format próbek
+     */
+    void calculateConstantQ(FrequencySpectrum &spectrum, const char *data, int inputFrequency,
+                            int bytesPerFrame, bool stereo, QAudioFormat::SampleFormat sampleFormat);
+
+    /*!
+     * \brief Okno i FFT jednego okna danych, wynik w m_output i m_outputRight
+     *
+     * \param[in] data - length() ramek audio
+     * \param[in] bytesPerFrame - ilość byte'ów na ramkę
+     * \param[in] stereo - czy liczyć prawy kanał
+     * \param[in] sampleFormat - format próbek
+     * \param[in] window - length() wartości okna
+     */
+    void transform(const char *data, int bytesPerFrame, bool stereo, QAudioFormat::SampleFormat sampleFormat,
+                   const float *window);
+
+    /*!
+     * \brief Wynik FFT kanału, mid i side są wyliczane z lewego i prawego
+     *
+     * \param[in] channel - kanał
+     * \param[out] DataType* - wynik FFT w układzie FFTReal, ważny do następnego wywołania
+     */
+    const DataType *channelOutput(FrequencySpectrum::Channel channel);
+
+    FFTRealWrapper*                             m_fft;
+    FFTRealStereoWrapper*                       m_stereoFft;
+
+    int                                         m_numSamples;
+    int                                         m_phaseHop;
+
+    AmplitudeScale                              m_scale;
+    float                                       m_scaleSlope;
+    float                                       m_scaleOffset;
+
+    WindowFunction                              m_windowFunction;
+    QSharedPointer<const WindowTable>           m_window;
+
+    int                                         m_constantQBands;
+    float                                       m_constantQLowFreq;
+    float                                       m_constantQHighFreq;
+    float                                       m_constantQSlope;
+    float                                       m_constantQOffset;
+    QSharedPointer<const ConstantQKernel>       m_constantQ;
+    QList<DataType>                             m_rectangular;
+    QList<float>                                m_bandReal;
+    QList<float>                                m_bandImag;
+
+    QList<DataType>                             m_input;
+    QList<DataType>                             m_output;
+    QList<DataType>                             m_inputRight;
+    QList<DataType>                             m_outputRight;
+    QList<DataType>                             m_outputMixed;
+    QList<DataType>                             m_interleaved;
+    QList<float>                                m_previousPhases;
+    FrequencySpectrum                           m_spectrum;
+};
+
+#endif // SPECTRUMCALCULATOR_H
@@ -0,0 +1,422 @@
+#include "spectrumkernels.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define SPECTRUMKERNELS_SSE2
+#    include <emmintrin.h>
+#endif
+
+namespace {
+
+// 2 / ln 2 times the coefficients of atanh: log2(m) = 2 atanh(t) / ln 2, t = (m - 1) / (m + 1)
+const float Log2C1 = 2.8853900818f;
+const float Log2C3 = 0.9617966939f;
+const float Log2C5 = 0.5770780164f;
+
+const float Sqrt2 = 1.4142135624f;
+
+// atan(a) = a (A1 + A3 a^2 + ... + A9 a^8) on [0, 1] (Abramowitz & Stegun 4.4.49); the table gives an
+// error of 1e-5, with these 7 digit coefficients it reaches 1.15e-5
+const float AtanA1 = 0.9998660f;
+const float AtanA3 = -0.3302995f;
+const float AtanA5 = 0.1801410f;
+const float AtanA7 = -0.0851330f;
+const float AtanA9 = 0.0208351f;
+
+const float Pi = 3.14159265359f;
+const float HalfPi = 1.57079632679f;
+const double TwoPi = 6.28318530717958648;
+
+// Documented bounds of the approximations, checked by checkApproximations()
+const double FastLog2MaxError = 6e-6;
+const double FastAtan2MaxError = 1.2e-5;
+
+// Largest relative difference between the SSE2 and scalar versions, a few float roundings
+const double SimdMaxDifference = 4.0 * FLT_EPSILON;
+
+inline void setClipped(quint32 *clipMask, int bin)
+{
+    clipMask[bin / 32] |= 1u << (bin % 32);
+}
+
+inline float amplitude(float power, float slope, float offset, quint32 *clipMask, int bin)
+{
+    const float value = slope * fastLog2(power) + offset;
+    if (value > 1.0f)
+    {
+        setClipped(clipMask, bin);
+        return 1.0f;
+    }
+    return value > 0.0f ? value : 0.0f;
+}
+
+#if defined(SPECTRUMKERNELS_SSE2)
+inline __m128 fastLog2x4(__m128 x)
+{
+    const __m128i bits = _mm_castps_si128(x);
+    __m128i exponent = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+    __m128 mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+                                                    _mm_set1_epi32(0x3f800000)));
+
+    // Into [sqrt(0.5), sqrt(2)), so that |t| <= 0.172
+    const __m128 above = _mm_cmpgt_ps(mantissa, _mm_set1_ps(Sqrt2));
+    mantissa = _mm_sub_ps(mantissa, _mm_and_ps(above, _mm_mul_ps(mantissa, _mm_set1_ps(0.5f))));
+    exponent = _mm_sub_epi32(exponent, _mm_castps_si128(above));
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 t = _mm_div_ps(_mm_sub_ps(mantissa, one), _mm_add_ps(mantissa, one));
+    const __m128 t2 = _mm_mul_ps(t, t);
+    __m128 p = _mm_add_ps(_mm_mul_ps(t2, _mm_set1_ps(Log2C5)), _mm_set1_ps(Log2C3));
+    p = _mm_add_ps(_mm_mul_ps(t2, p), _mm_set1_ps(Log2C1));
+    return _mm_add_ps(_mm_cvtepi32_ps(exponent), _mm_mul_ps(t, p));
+}
+
+inline __m128 blend(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline __m128 fastAtan2x4(__m128 y, __m128 x)
+{
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 ax = _mm_andnot_ps(signBit, x);
+    const __m128 ay = _mm_andnot_ps(signBit, y);
+
+    // Ratio in [0, 1], 0 instead of NaN for the origin
+    const __m128 larger = _mm_max_ps(ax, ay);
+    const __m128 a = _mm_and_ps(_mm_cmpgt_ps(larger, _mm_setzero_ps()),
+                                _mm_div_ps(_mm_min_ps(ax, ay), larger));
+    const __m128 a2 = _mm_mul_ps(a, a);
+    __m128 r = _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(AtanA9)), _mm_set1_ps(AtanA7));
+    r = _mm_add_ps(_mm_mul_ps(a2, r), _mm_set1_ps(AtanA5));
+    r = _mm_add_ps(_mm_mul_ps(a2, r), _mm_set1_ps(AtanA3));
+    r = _mm_add_ps(_mm_mul_ps(a2, r), _mm_set1_ps(AtanA1));
+    r = _mm_mul_ps(a, r);
+
+    // Back to the octant and quadrant of (x, y)
+    r = blend(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(HalfPi), r), r);
+    r = blend(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(Pi), r), r);
+    return _mm_or_ps(r, _mm_and_ps(y, signBit));
+}
+#endif
+
+/*!
+ * \brief Amplitudes of bins [begin, end) from separate real and imaginary parts
+ */
+void binAmplitudes(const float *real, const float *imag, int begin, int end, float slope, float offset,
+                   float *amplitudes, quint32 *clipMask)
+{
+    int i = begin;
+#if defined(SPECTRUMKERNELS_SSE2)
+    const __m128 slope4 = _mm_set1_ps(slope);
+    const __m128 offset4 = _mm_set1_ps(offset);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    for ( ; i + 4 <= end; i += 4)
+    {
+        const __m128 re = _mm_loadu_ps(real + i);
+        const __m128 im = _mm_loadu_ps(imag + i);
+        const __m128 power = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+        const __m128 value = _mm_add_ps(_mm_mul_ps(fastLog2x4(power), slope4), offset4);
+
+        const int clipped = _mm_movemask_ps(_mm_cmpgt_ps(value, one));
+        if (clipped)
+        {
+            for (int k = 0; k < 4; ++k)
+            {
+                if (clipped & (1 << k))
+                {
+                    setClipped(clipMask, i + k);
+                }
+            }
+        }
+        _mm_storeu_ps(amplitudes + i, _mm_min_ps(_mm_max_ps(value, zero), one));
+    }
+#endif
+
+    for ( ; i < end; ++i)
+    {
+        amplitudes[i] = amplitude(real[i] * real[i] + imag[i] * imag[i], slope, offset, clipMask, i);
+    }
+}
+
+/*!
+ * \brief Phases of bins [begin, end), imaginary parts negated if negatedImag
+ */
+void binPhases(const float *real, const float *imag, int begin, int end, bool negatedImag, float *phases)
+{
+    int i = begin;
+#if defined(SPECTRUMKERNELS_SSE2)
+    const __m128 sign = negatedImag ? _mm_set1_ps(-0.0f) : _mm_setzero_ps();
+    for ( ; i + 4 <= end; i += 4)
+    {
+        _mm_storeu_ps(phases + i, fastAtan2x4(_mm_xor_ps(_mm_loadu_ps(imag + i), sign), _mm_loadu_ps(real + i)));
+    }
+#endif
+
+    for ( ; i < end; ++i)
+    {
+        phases[i] = fastAtan2(negatedImag ? -imag[i] : imag[i], real[i]);
+    }
+}
+
+} // namespace
+
+float fastLog2(float x)
+{
+    quint32 bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int exponent = int(bits >> 23) - 127;
+    bits = (bits & 0x007fffffu) | 0x3f800000u;
+    float mantissa;
+    memcpy(&mantissa, &bits, sizeof(mantissa));
+
+    if (mantissa > Sqrt2)
+    {
+        mantissa *= 0.5f;
+        ++exponent;
+    }
+
+    const float t = (mantissa - 1.0f) / (mantissa + 1.0f);
+    const float t2 = t * t;
+    return float(exponent) + t * (Log2C1 + t2 * (Log2C3 + t2 * Log2C5));
+}
+
+float fastAtan2(float y, float x)
+{
+    const float ax = std::fabs(x);
+    const float ay = std::fabs(y);
+    const float larger = ax > ay ? ax : ay;
+    const float a = larger > 0.0f ? (ax < ay ? ax : ay) / larger : 0.0f;
+    const float a2 = a * a;
+    float r = a * (AtanA1 + a2 * (AtanA3 + a2 * (AtanA5 + a2 * (AtanA7 + a2 * AtanA9))));
+
+    if (ay > ax)
+    {
+        r = HalfPi - r;
+    }
+    if (x < 0.0f)
+    {
+        r = Pi - r;
+    }
+    return std::signbit(y) ? -r : r;
+}
+
+void powerToAmplitudes(const float *output, int fftLength, float slope, float offset, int firstBin,
+                       float *amplitudes, quint32 *clipMask)
+{
+    const int half = fftLength / 2;
+    memset(clipMask, 0, size_t((half + 32) / 32) * sizeof(quint32));
+
+    int i = 0;
+    for ( ; i < firstBin && i <= half; ++i)
+    {
+        amplitudes[i] = 0.0f;
+    }
+
+    // DC and Nyquist have no imaginary part
+    if (0 == i)
+    {
+        amplitudes[0] = amplitude(output[0] * output[0], slope, offset, clipMask, 0);
+        ++i;
+    }
+
+    const float *real = output;
+    const float *imag = output + half;
+
+    binAmplitudes(real, imag, i, half, slope, offset, amplitudes, clipMask);
+    i = qMax(i, half);
+
+    if (i == half && half > 0)
+    {
+        amplitudes[half] = amplitude(real[half] * real[half], slope, offset, clipMask, half);
+    }
+}
+
+void amplitudeScaleCoefficients(const AmplitudeScale &scale, int fftLength, float coherentGain,
+                                float multiplier, float *slope, float *offset)
+{
+    // Gain of the window relative to Hann, whose full scale sine gives |X| = N / 4
+    const double gain = qMax(1e-6, double(coherentGain)) / 0.5;
+
+    switch (scale.mode)
+    {
+    case AmplitudeScale::Decibel:
+    {
+        // 10 log10(power), relative to a full scale sine
+        const double range = qMax(1e-3, double(scale.ceiling) - double(scale.floor));
+        const double fullScale = 20.0 * std::log10(qMax(1e-6, gain * fftLength / 4.0));
+        *slope = float(10.0 * std::log10(2.0) / range);
+        *offset = float((-fullScale - scale.floor) / range);
+        break;
+    }
+    case AmplitudeScale::Logarithmic:
+    default:
+        // multiplier * ln(|X| / gain) = multiplier * ln(2) / 2 * log2(power) - multiplier * ln(gain)
+        *slope = float(multiplier * std::log(2.0) / 2.0);
+        *offset = float(-multiplier * std::log(gain));
+        break;
+    }
+}
+
+void spectrumPhases(const float *output, int fftLength, float *phases)
+{
+    const int half = fftLength / 2;
+    if (half <= 0)
+    {
+        return;
+    }
+
+    // DC and Nyquist have no imaginary part; FFTReal stores the others negated
+    const float *real = output;
+    const float *imag = output + half;
+    phases[0] = fastAtan2(0.0f, real[0]);
+
+    binPhases(real, imag, 1, half, true, phases);
+    phases[half] = fastAtan2(0.0f, real[half]);
+}
+
+void instantaneousFrequencies(const float *phases, const float *previousPhases, int numBins,
+                              int fftLength, int hop, float sampleRate, float *frequencies)
+{
+    if (fftLength <= 0 || hop <= 0)
+    {
+        return;
+    }
+
+    // The phase of bin k advances by 2 pi k hop / N over a hop; k hop mod N is kept exact
+    // in integers, a float product loses the fraction for large k and hop
+    const int step = hop % fftLength;
+    const float phaseScale = float(TwoPi / fftLength);
+    const float binWidth = sampleRate / fftLength;
+    const float deviationScale = float(sampleRate / (TwoPi * hop));
+
+    int advance = 0;
+    for (int k = 0; k < numBins; ++k)
+    {
+        float deviation = phases[k] - previousPhases[k] - phaseScale * float(advance);
+        deviation -= float(TwoPi) * std::floor((deviation + Pi) * float(1.0 / TwoPi));
+        frequencies[k] = float(k) * binWidth + deviation * deviationScale;
+
+        advance += step;
+        if (advance >= fftLength)
+        {
+            advance -= fftLength;
+        }
+    }
+}
+
+void bandAmplitudes(const float *real, const float *imag, int count, float slope, float offset,
+                    float *amplitudes, quint32 *clipMask)
+{
+    memset(clipMask, 0, size_t((count + 31) / 32) * sizeof(quint32));
+    binAmplitudes(real, imag, 0, count, slope, offset, amplitudes, clipMask);
+}
+
+void bandPhases(const float *real, const float *imag, int count, float *phases)
+{
+    binPhases(real, imag, 0, count, false, phases);
+}
+
+bool checkApproximations(double *log2Error, double *atan2Error, double *simdDifference)
+{
+    double logError = 0.0;
+    double atanError = 0.0;
+    double difference = 0.0;
+
+#if defined(SPECTRUMKERNELS_SSE2)
+    auto simdCheck = [&difference](float simd, float scalar) {
+        difference = qMax(difference, std::fabs(double(simd) - double(scalar)) / qMax(1.0, std::fabs(double(scalar))));
+    };
+#endif
+
+    // 4096 mantissas of every normal exponent, and the mantissas around sqrt(2) where the range is folded
+    const quint32 sqrt2Mantissa = 0x3504f3u;
+    const quint32 mantissas[] = { sqrt2Mantissa - 1, sqrt2Mantissa, sqrt2Mantissa + 1, 0x7fffffu };
+    for (quint32 exponent = 1; exponent <= 254; ++exponent)
+    {
+        float values[4096 + 4];
+        int count = 0;
+        for (quint32 mantissa = 0; mantissa < 0x800000u; mantissa += 0x800u)
+        {
+            const quint32 bits = (exponent << 23) | mantissa;
+            memcpy(&values[count++], &bits, sizeof(float));
+        }
+        for (quint32 mantissa : mantissas)
+        {
+            const quint32 bits = (exponent << 23) | mantissa;
+            memcpy(&values[count++], &bits, sizeof(float));
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            const float approximation = fastLog2(values[i]);
+            logError = qMax(logError, std::fabs(double(approximation) - std::log2(double(values[i]))));
+        }
+
+#if defined(SPECTRUMKERNELS_SSE2)
+        for (int i = 0; i + 4 <= count; i += 4)
+        {
+            float simd[4];
+            _mm_storeu_ps(simd, fastLog2x4(_mm_loadu_ps(values + i)));
+            for (int k = 0; k < 4; ++k)
+            {
+                simdCheck(simd[k], fastLog2(values[i + k]));
+            }
+        }
+#endif
+    }
+
+    // Full circle at radii far apart, the axes and the origin
+    const int angles = 65536;
+    const float radii[] = { 0x1p-60f, 0x1p-20f, 1.0f, 0x1p20f, 0x1p60f };
+    for (float radius : radii)
+    {
+        for (int i = 0; i < angles; i += 4)
+        {
+            float y[4];
+            float x[4];
+            for (int k = 0; k < 4; ++k)
+            {
+                const double angle = TwoPi * (i + k) / angles - TwoPi / 2.0;
+                y[k] = float(radius * std::sin(angle));
+                x[k] = float(radius * std::cos(angle));
+                atanError = qMax(atanError, std::fabs(double(fastAtan2(y[k], x[k])) - std::atan2(double(y[k]), double(x[k]))));
+            }
+
+#if defined(SPECTRUMKERNELS_SSE2)
+            float simd[4];
+            _mm_storeu_ps(simd, fastAtan2x4(_mm_loadu_ps(y), _mm_loadu_ps(x)));
+            for (int k = 0; k < 4; ++k)
+            {
+                simdCheck(simd[k], fastAtan2(y[k], x[k]));
+            }
+#endif
+        }
+
+        const float axesY[4] = { 0.0f, radius, 0.0f, -radius };
+        const float axesX[4] = { radius, 0.0f, -radius, 0.0f };
+        for (int k = 0; k < 4; ++k)
+        {
+            atanError = qMax(atanError, std::fabs(double(fastAtan2(axesY[k], axesX[k])) - std::atan2(double(axesY[k]), double(axesX[k]))));
+        }
+
+#if defined(SPECTRUMKERNELS_SSE2)
+        float simd[4];
+        _mm_storeu_ps(simd, fastAtan2x4(_mm_loadu_ps(axesY), _mm_loadu_ps(axesX)));
+        for (int k = 0; k < 4; ++k)
+        {
+            simdCheck(simd[k], fastAtan2(axesY[k], axesX[k]));
+        }
+#endif
+    }
+    atanError = qMax(atanError, std::fabs(double(fastAtan2(0.0f, 0.0f))));
+
+    *log2Error = logError;
+    *atan2Error = atanError;
+    *simdDifference = difference;
+    return logError < FastLog2MaxError && atanError < FastAtan2MaxError && difference <= SimdMaxDifference;
+}
@@ -0,0 +1,148 @@
+#ifndef SPECTRUMKERNELS_H
+#define SPECTRUMKERNELS_H
+
+#include <QtGlobal>
+
+/*!
+ * \brief Mapping of the power of a bin to an amplitude in range [0.0, 1.0]
+ *
+ * Logarithmic - SpectrumAnalyserMultiplier * ln|X|, the original scale of the application
+ * Decibel - level in dBFS (0 dB for a full scale sine) mapped linearly from [floor, ceiling]
+ */
+struct AmplitudeScale
+{
+    enum Mode {
+        Logarithmic,
+        Decibel
+    };
+
+    Mode    mode = Logarithmic;
+    float   floor = -90.0f;
+    float   ceiling = 0.0f;
+};
+
+/*!
+ * \brief Approximation of log2
+ *
+ * The mantissa is reduced to [sqrt(0.5), sqrt(2)) and log2 is taken from the atanh
+ * series up to the 5th power. The truncation error is below 2e-6; with the rounding
+ * of the result the absolute error stays below 6e-6 for all positive normal floats,
+ * i.e. below 2e-5 dB. Zero and denormals give about -127.
+ * \param[in] x - positive value
+ * \param[out] float - log2(x)
+ */
+float fastLog2(float x);
+
+/*!
+ * \brief Approximation of atan2
+ *
+ * Polynomial on the octant, absolute error below 1.2e-5 rad.
+ * \param[in] y - imaginary part
+ * \param[in] x - real part
+ * \param[out] float - angle in range [-PI, PI], 0 for the origin
+ */
+float fastAtan2(float y, float x);
+
+/*!
+ * \brief Amplitudes of the bins of an FFTReal transform
+ *
+ * amplitude = slope * log2(re^2 + im^2) + offset, clamped to [0.0, 1.0]; the bits of the
+ * bins above 1.0 are set in the clipping mask. Bins below firstBin are zeroed. Computed
+ * in float, 4 bins at a time with SSE2 where available.
+ * \param[in] output - FFTReal output, real parts in [0, N/2], imaginary parts in [N/2 + 1, N - 1]
+ * \param[in] fftLength - N
+ * \param[in] slope - scale of log2 of the power
+ * \param[in] offset - amplitude of power 1
+ * \param[in] firstBin - first bin to compute
+ * \param[out] amplitudes - N/2 + 1 amplitudes
+ * \param[out] clipMask - (N/2 + 32) / 32 words, cleared first
+ */
+void powerToAmplitudes(const float *output, int fftLength, float slope, float offset, int firstBin,
+                       float *amplitudes, quint32 *clipMask);
+
+/*!
+ * \brief Amplitudes of bands given as separate real and imaginary parts
+ *
+ * Same mapping as powerToAmplitudes, for the output of a constant-Q transform.
+ * \param[in] real - real parts
+ * \param[in] imag - imaginary parts
+ * \param[in] count - number of bands
+ * \param[in] slope - scale of log2 of the power
+ * \param[in] offset - amplitude of power 1
+ * \param[out] amplitudes - count amplitudes
+ * \param[out] clipMask - (count + 31) / 32 words, cleared first
+ */
+void bandAmplitudes(const float *real, const float *imag, int count, float slope, float offset,
+                    float *amplitudes, quint32 *clipMask);
+
+/*!
+ * \brief Slope and offset of powerToAmplitudes for a scale
+ *
+ * Both scales are normalised by the coherent gain of the window, so a tone gives the
+ * same amplitude whichever window is used; with Hann the Logarithmic scale stays as it was.
+ * \param[in] scale - amplitude scale
+ * \param[in] fftLength - N, the level of a full scale sine depends on it
+ * \param[in] coherentGain - mean of the window, 0.5 for Hann
+ * \param[in] multiplier - multiplier of the Logarithmic scale
+ * \param[out] slope - scale of log2 of the power
+ * \param[out] offset - amplitude of power 1
+ */
+void amplitudeScaleCoefficients(const AmplitudeScale &scale, int fftLength, float coherentGain,
+                                float multiplier, float *slope, float *offset);
+
+/*!
+ * \brief Phases of the bins of an FFTReal transform
+ *
+ * FFTReal stores the imaginary parts negated, the phases follow the usual convention of
+ * X[k] = sum x[n] exp(-2 pi i k n / N). Computed 4 bins at a time with SSE2 where available.
+ * \param[in] output - FFTReal output, real parts in [0, N/2], negated imaginary parts in [N/2 + 1, N - 1]
+ * \param[in] fftLength - N
+ * \param[out] phases - N/2 + 1 phases in range [-PI, PI]
+ */
+void spectrumPhases(const float *output, int fftLength, float *phases);
+
+/*!
+ * \brief Phases of bands given as separate real and imaginary parts
+ *
+ * \param[in] real - real parts
+ * \param[in] imag - imaginary parts
+ * \param[in] count - number of bands
+ * \param[out] phases - count phases in range [-PI, PI]
+ */
+void bandPhases(const float *real, const float *imag, int count, float *phases);
+
+/*!
+ * \brief Instantaneous frequencies of the bins, phase vocoder style
+ *
+ * The phase advance of each bin between two transforms a hop apart, less the advance
+ * of the bin centre, gives the offset of the frequency from the centre. The offset is
+ * unambiguous within +-N / (2 hop) bins, i.e. +-2 bins for a hop of N / 4.
+ * \param[in] phases - phases of the later transform
+ * \param[in] previousPhases - phases of the transform one hop earlier
+ * \param[in] numBins - number of bins
+ * \param[in] fftLength - N
+ * \param[in] hop - distance between the transforms in samples
+ * \param[in] sampleRate - sample rate in Hz
+ * \param[out] frequencies - frequency of each bin in Hz
+ */
+void instantaneousFrequencies(const float *phases, const float *previousPhases, int numBins,
+                              int fftLength, int hop, float sampleRate, float *frequencies);
+
+/*!
+ * \brief Errors of fastLog2 and fastAtan2
+ *
+ * fastLog2 is swept over all exponents of the positive normal floats, 4096 mantissas
+ * each plus both sides of sqrt(2), and compared with std::log2. fastAtan2 is swept over
+ * 65536 angles at radii from 2^-60 to 2^60, the axes and the origin, and compared with
+ * std::atan2. With SSE2 the 4-wide versions are run on the same inputs and compared with
+ * the scalar ones.
+ * \param[out] log2Error - largest absolute error of fastLog2
+ * \param[out] atan2Error - largest absolute error of fastAtan2 in rad
+ * \param[out] simdDifference - largest difference between SSE2 and scalar results relative
+ *                              to max(1, |result|), 0 without SSE2
+ * \return If the errors are below the documented 6e-6 and 1.2e-5 rad and the SSE2 results
+ *         match the scalar ones to float rounding
+ */
+bool checkApproximations(double *log2Error, double *atan2Error, double *simdDifference);
+
+#endif // SPECTRUMKERNELS_H
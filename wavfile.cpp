@@ -0,0 +1,137 @@
+#include "wavfile.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+// Format tags of the fmt chunk
+const quint16 WavFormatPcm          = 0x0001;
+const quint16 WavFormatIeeeFloat    = 0x0003;
+const quint16 WavFormatExtensible   = 0xFFFE;
+
+WavFile::WavFile()
+    :   m_map(nullptr)
+    ,   m_data(nullptr)
+    ,   m_frameCount(0)
+{
+}
+
+WavFile::~WavFile()
+{
+    close();
+}
+
+bool WavFile::open(const QString &fileName)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        return fail(m_file.errorString());
+    }
+
+    const qint64 size = m_file.size();
+    m_map = m_file.map(0, size);
+    if (!m_map)
+    {
+        return fail(m_file.errorString());
+    }
+
+    const char *ptr = reinterpret_cast<const char*>(m_map);
+    if (size < 12 || memcmp(ptr, "RIFF", 4) != 0 || memcmp(ptr + 8, "WAVE", 4) != 0)
+    {
+        return fail(QStringLiteral("not a RIFF/WAVE file"));
+    }
+
+    // Walk the chunks, fmt has to come before data
+    quint16 formatTag = 0;
+    int channels = 0;
+    int sampleRate = 0;
+    int bitsPerSample = 0;
+    int blockAlign = 0;
+    qint64 offset = 12;
+    while (offset + 8 <= size)
+    {
+        const char *chunk = ptr + offset;
+        const qint64 chunkSize = qFromLittleEndian<quint32>(chunk + 4);
+        const char *body = chunk + 8;
+        const qint64 available = qMin(chunkSize, size - offset - 8);
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && available >= 16)
+        {
+            formatTag = qFromLittleEndian<quint16>(body);
+            channels = qFromLittleEndian<quint16>(body + 2);
+            sampleRate = int(qFromLittleEndian<quint32>(body + 4));
+            blockAlign = qFromLittleEndian<quint16>(body + 12);
+            bitsPerSample = qFromLittleEndian<quint16>(body + 14);
+
+            // The sub format GUID starts with the real format tag
+            if (WavFormatExtensible == formatTag && available >= 26)
+            {
+                formatTag = qFromLittleEndian<quint16>(body + 24);
+            }
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            if (0 == channels)
+            {
+                return fail(QStringLiteral("data chunk before fmt chunk"));
+            }
+
+            QAudioFormat::SampleFormat sampleFormat = QAudioFormat::Unknown;
+            if (WavFormatPcm == formatTag)
+            {
+                switch (bitsPerSample)
+                {
+                case 8:  sampleFormat = QAudioFormat::UInt8; break;
+                case 16: sampleFormat = QAudioFormat::Int16; break;
+                case 32: sampleFormat = QAudioFormat::Int32; break;
+                default: break;
+                }
+            }
+            else if (WavFormatIeeeFloat == formatTag && 32 == bitsPerSample)
+            {
+                sampleFormat = QAudioFormat::Float;
+            }
+
+            if (QAudioFormat::Unknown == sampleFormat || blockAlign != channels * bitsPerSample / 8)
+            {
+                return fail(QStringLiteral("unsupported sample format (tag %1, %2 bits)")
+                            .arg(formatTag).arg(bitsPerSample));
+            }
+
+            m_format.setSampleFormat(sampleFormat);
+            m_format.setChannelCount(channels);
+            m_format.setSampleRate(sampleRate);
+            m_data = body;
+            m_frameCount = available / blockAlign;
+            return true;
+        }
+
+        // Chunks are padded to an even size
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    return fail(QStringLiteral("no data chunk"));
+}
+
+void WavFile::close()
+{
+    if (m_map)
+    {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    m_file.close();
+    m_data = nullptr;
+    m_frameCount = 0;
+    m_format = QAudioFormat();
+}
+
+bool WavFile::fail(const QString &reason)
+{
+    m_errorString = reason;
+    close();
+    return false;
+}
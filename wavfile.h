@@ -0,0 +1,66 @@
+#ifndef WAVFILE_H
+#define WAVFILE_H
+
+#include <QAudioFormat>
+#include <QFile>
+#include <QString>
+
+/*!
+ * \brief WavFile Class
+ *
+ * Read-only view of a RIFF/WAVE file. The file is memory-mapped and the sample
+ * data is handed out as a pointer into the mapping, so frames can be fed to the
+ * analysis without being copied. Integer PCM of 8, 16 and 32 bits and 32-bit
+ * float are supported, including WAVE_FORMAT_EXTENSIBLE headers.
+ */
+class WavFile
+{
+public:
+    WavFile();
+    ~WavFile();
+
+    /*!
+     * \brief Opens and maps a file
+     *
+     * \param[in] fileName - path of the file
+     * \return If the file is a supported WAV file
+     */
+    bool open(const QString &fileName);
+
+    /*!
+     * \brief Unmaps and closes the file
+     */
+    void close();
+
+    /*!
+     * \brief Reason of the last failure of open
+     */
+    QString errorString() const { return m_errorString; }
+
+    /*!
+     * \brief Format of the samples
+     */
+    const QAudioFormat &format() const { return m_format; }
+
+    /*!
+     * \brief First byte of the sample data, inside the mapping
+     */
+    const char *data() const { return m_data; }
+
+    /*!
+     * \brief Number of complete frames in the data chunk
+     */
+    qint64 frameCount() const { return m_frameCount; }
+
+private:
+    bool fail(const QString &reason);
+
+    QFile               m_file;
+    uchar*              m_map;
+    const char*         m_data;
+    qint64              m_frameCount;
+    QAudioFormat        m_format;
+    QString             m_errorString;
+};
+
+#endif // WAVFILE_H
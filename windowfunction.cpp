@@ -0,0 +1,170 @@
+#include "windowfunction.h"
+
+#include <QHash>
+#include <QMutex>
+#include <qmath.h>
+
+#include <cstring>
+#include <new>
+
+// Tables start on a cache line, so no vector load of the window is split
+const std::size_t WindowTableAlignment = 64;
+
+const float KaiserDefaultBeta = 8.6f;
+const float GaussianDefaultSigma = 0.4f;
+
+static const char *WindowNames[WindowFunction::TypeCount] = {
+    "hann",
+    "hamming",
+    "blackman-harris",
+    "kaiser",
+    "flat-top",
+    "gaussian"
+};
+
+float WindowFunction::effectiveParameter() const
+{
+    switch (type)
+    {
+    case Kaiser:
+        return parameter > 0.0f ? parameter : KaiserDefaultBeta;
+    case Gaussian:
+        return parameter > 0.0f ? parameter : GaussianDefaultSigma;
+    default:
+        return 0.0f;
+    }
+}
+
+const char *WindowFunction::name(Type type)
+{
+    return type >= 0 && type < TypeCount ? WindowNames[type] : "";
+}
+
+WindowFunction::Type WindowFunction::typeFromName(const QString &name, bool *ok)
+{
+    for (int i = 0; i < TypeCount; ++i)
+    {
+        if (name.compare(QLatin1String(WindowNames[i]), Qt::CaseInsensitive) == 0)
+        {
+            if (ok)
+            {
+                *ok = true;
+            }
+            return Type(i);
+        }
+    }
+
+    if (ok)
+    {
+        *ok = false;
+    }
+    return Hann;
+}
+
+/*!
+ * \brief Modified Bessel function of the first kind, order 0
+ */
+static double besselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    const double halfSquared = 0.25 * x * x;
+    for (int k = 1; k < 500 && term > 1e-12 * sum; ++k)
+    {
+        term *= halfSquared / (double(k) * k);
+        sum += term;
+    }
+    return sum;
+}
+
+/*!
+ * \brief Sum of cosines window, a0 - a1 cos(x) + a2 cos(2x) - ...
+ */
+static double cosineSum(const double *coefficients, int count, double x)
+{
+    double value = 0.0;
+    double sign = 1.0;
+    for (int k = 0; k < count; ++k)
+    {
+        value += sign * coefficients[k] * std::cos(k * x);
+        sign = -sign;
+    }
+    return value;
+}
+
+WindowTable::WindowTable(const WindowFunction &function, int length)
+    :   m_data(static_cast<float*>(::operator new[](qMax(length, 1) * sizeof(float),
+                                                    std::align_val_t(WindowTableAlignment))))
+    ,   m_length(length)
+    ,   m_coherentGain(0.0f)
+{
+    static const double HammingCoefficients[] = { 0.54, 0.46 };
+    static const double BlackmanHarrisCoefficients[] = { 0.35875, 0.48829, 0.14128, 0.01168 };
+    static const double FlatTopCoefficients[] = { 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 };
+
+    // Symmetric windows, like the original Hann window
+    const double span = qMax(1, length - 1);
+    const double parameter = function.effectiveParameter();
+    const double kaiserNorm = 1.0 / besselI0(parameter);
+
+    double sum = 0.0;
+    for (int i = 0; i < length; ++i)
+    {
+        const double x = 2.0 * M_PI * i / span;
+        const double centered = 2.0 * i / span - 1.0;    // [-1, 1]
+
+        double value = 0.0;
+        switch (function.type)
+        {
+        case WindowFunction::Hamming:
+            value = cosineSum(HammingCoefficients, 2, x);
+            break;
+        case WindowFunction::BlackmanHarris:
+            value = cosineSum(BlackmanHarrisCoefficients, 4, x);
+            break;
+        case WindowFunction::Kaiser:
+            value = besselI0(parameter * std::sqrt(qMax(0.0, 1.0 - centered * centered))) * kaiserNorm;
+            break;
+        case WindowFunction::FlatTop:
+            value = cosineSum(FlatTopCoefficients, 5, x);
+            break;
+        case WindowFunction::Gaussian:
+            value = std::exp(-0.5 * (centered / parameter) * (centered / parameter));
+            break;
+        case WindowFunction::Hann:
+        default:
+            value = 0.5 * (1.0 - std::cos(x));
+            break;
+        }
+
+        m_data[i] = float(value);
+        sum += value;
+    }
+
+    m_coherentGain = length > 0 ? float(sum / length) : 0.0f;
+}
+
+WindowTable::~WindowTable()
+{
+    ::operator delete[](m_data, std::align_val_t(WindowTableAlignment));
+}
+
+QSharedPointer<const WindowTable> WindowTable::get(const WindowFunction &function, int length)
+{
+    static QMutex mutex;
+    static QHash<quint64, QSharedPointer<const WindowTable>> tables;
+
+    // Windows without a parameter share one table whatever the parameter says
+    const float parameter = function.effectiveParameter();
+    quint32 parameterBits = 0;
+    std::memcpy(&parameterBits, &parameter, sizeof(parameterBits));
+
+    const quint64 key = (quint64(parameterBits) << 32) | (quint64(function.type) << 24) | quint32(length);
+    QMutexLocker locker(&mutex);
+    QSharedPointer<const WindowTable> &table = tables[key];
+    if (!table)
+    {
+        table.reset(new WindowTable(function, length));
+    }
+    return table;
+}
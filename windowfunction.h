@@ -0,0 +1,100 @@
+#ifndef WINDOWFUNCTION_H
+#define WINDOWFUNCTION_H
+
+#include <QSharedPointer>
+#include <QString>
+
+/*!
+ * \brief Window applied to the samples before the FFT
+ *
+ * Hann - general purpose, the original window of the application
+ * Hamming - narrower main lobe, higher far sidelobes
+ * BlackmanHarris - 4-term, sidelobes below -92 dB, for a low-leakage bass display
+ * Kaiser - sidelobes traded against the main lobe with parameter beta (8.6 by default)
+ * FlatTop - flat passband, for accurate level readings of tones between bins
+ * Gaussian - width set by parameter sigma relative to half the window (0.4 by default)
+ */
+struct WindowFunction
+{
+    enum Type {
+        Hann,
+        Hamming,
+        BlackmanHarris,
+        Kaiser,
+        FlatTop,
+        Gaussian,
+        TypeCount
+    };
+
+    Type    type = Hann;
+    float   parameter = 0.0f;
+
+    /*!
+     * \brief Parameter of the window
+     *
+     * The default one if parameter is 0, always 0 for windows without a parameter.
+     */
+    float effectiveParameter() const;
+
+    /*!
+     * \brief Command line name of a window type
+     *
+     * \param[in] type - window type
+     * \param[out] const char* - e.g. "blackman-harris"
+     */
+    static const char *name(Type type);
+
+    /*!
+     * \brief Window type from its command line name
+     *
+     * \param[in] name - hann, hamming, blackman-harris, kaiser, flat-top or gaussian
+     * \param[out] ok - set to false if the name is unknown
+     */
+    static Type typeFromName(const QString &name, bool *ok = nullptr);
+};
+
+/*!
+ * \brief Precomputed window of one type and length
+ *
+ * Tables are built once per window and length, cached for the lifetime of the
+ * application and shared read-only between all calculators. The values are
+ * aligned to a cache line for the vector loops of sampleconversion.cpp.
+ */
+class WindowTable
+{
+public:
+    ~WindowTable();
+
+    /*!
+     * \brief Shared table of a window
+     *
+     * Builds the table on the first request; later requests only look it up.
+     * \param[in] function - window type and parameter
+     * \param[in] length - number of samples
+     */
+    static QSharedPointer<const WindowTable> get(const WindowFunction &function, int length);
+
+    /*!
+     * \brief Window values, length() samples
+     */
+    const float *data() const { return m_data; }
+
+    int length() const { return m_length; }
+
+    /*!
+     * \brief Coherent gain, the mean of the window
+     *
+     * A full scale sine in the middle of a bin gives |X| = N * coherentGain() / 2.
+     */
+    float coherentGain() const { return m_coherentGain; }
+
+private:
+    WindowTable(const WindowFunction &function, int length);
+    Q_DISABLE_COPY(WindowTable)
+
+    float*      m_data;
+    int         m_length;
+    float       m_coherentGain;
+};
+
+#endif // WINDOWFUNCTION_H